@@ -0,0 +1,77 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include "archive.h"
+#include "mapped_file.h"
+#include "ss_exceptions.h"
+
+using namespace ss;
+
+const std::string usage = "ar -o <archive> <object>... | ar -t <archive>";
+
+//Prints members of an archive and symbols in its index.
+void list(const std::string& file) {
+    std::unique_ptr<MappedFile> mapping(new MappedFile(file));
+
+    if (!mapping->isOpen()) {
+        throw LinkingException("Cannot open file " + file);
+    }
+
+    Archive archive(std::move(mapping), file);
+
+    for (int i = 0; i < archive.memberCount(); ++i) {
+        std::cout << archive.memberName(i).str() << " " << archive.memberSize(i) << "\n";
+    }
+    for (int i = 0; i < archive.symbolCount(); ++i) {
+        std::cout << archive.symbolName(i).str() << " " << archive.memberName(archive.symbolMember(i)).str() << "\n";
+    }
+    std::cout << std::flush;
+}
+
+int main(int argc, const char* argv[]) {
+    std::string output;
+    std::string listed;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+
+        if ((arg.compare("-o") == 0) || (arg.compare("-t") == 0)) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing archive file.\n" << usage << std::endl;
+                return -1;
+            }
+            (arg.compare("-o") == 0 ? output : listed) = argv[++i];
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+
+    if (!listed.empty() && output.empty() && files.empty()) {
+        try {
+            list(listed);
+        }
+        catch (std::exception& e) {
+            std::cout << e.what() << std::flush;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (output.empty() || files.empty() || !listed.empty()) {
+        std::cout << "ERROR: insufficient number of parameters.\n" << usage << std::endl;
+        return -1;
+    }
+
+    try {
+        Archive::write(files, output);
+    }
+    catch (std::exception& e) {
+        std::cout << e.what() << std::flush;
+        return 1;
+    }
+
+    return 0;
+}
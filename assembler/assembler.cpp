@@ -10,6 +10,8 @@
 
 
 #include "assembler.h"
+#include "mapped_file.h"
+#include "object_cache.h"
 #include "utils.h"
 #include "string_tokenizer.h"
 #include "symbol.h"
@@ -24,9 +26,7 @@
 
 using namespace ss;
 
-std::map<std::string, char> Assembler::reservedWords;
-
-Assembler::Assembler(std::ifstream* in, std::ofstream* out, std::ofstream* outPretty, unsigned short start) : input(in), output(out), objdumpOut(outPretty), startAddress(start) {
+Assembler::Assembler(MappedFile* in, StringView source, std::ofstream* out, const std::string& listingFile, unsigned short start) : input(in), source(source), output(out), listingFile(listingFile), startAddress(start) {
 
 }
 
@@ -42,154 +42,137 @@ void Assembler::move(Assembler& a) {
 
 Assembler* Assembler::getInstance(std::string& inputFile, std::string& outputFile, unsigned short startAddress) {
     
-    //Creating input stream.
-    std::ifstream* in = new std::ifstream(inputFile, std::ifstream::in);
+    //Input is mapped, lines are scanned as views into it.
+    MappedFile* in = new MappedFile(inputFile);
 
     //Creating output stream.
     std::ofstream* out = new std::ofstream(outputFile + ".o", std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
-    
-    std::ofstream* outPretty = new std::ofstream(outputFile, std::ofstream::out | std::ofstream::trunc);
 
     //Checking if output stream was created correctly.
     std::string message = Utils::empty;
     if (!out->is_open()) {
         message += "Cannot open file " + outputFile + ".o" + ".\n";
 
-        throw FileException(message.c_str());
-    }
-
-
-    if (!out->is_open()) {
-        message += "Cannot open file " + outputFile + ".\n";
+        delete out;
+        delete in;
 
-        throw FileException(message.c_str());
+        throw FileException(message);
     }
 
     //Checking if input stream was created correctly.
-    if (!in->is_open()) {
+    if (!in->isOpen()) {
         message += "Cannot open file " + inputFile + ".\n";
         
         out->close();
         delete out;
+        delete in;
   
-        throw FileException(message.c_str());
+        throw FileException(message);
     }
     
-    Assembler::initStatic();
-
-    return new Assembler(in, out, outPretty, startAddress);
+    return new Assembler(in, StringView(in->data(), in->size()), out, outputFile, startAddress);
 }
 
-bool Assembler::checkReserved(std::string label) {
-    if (Assembler::reservedWords.find(label) != Assembler::reservedWords.end()) {
-        return true;
-    }
+Assembler* Assembler::getInstance(StringView source, unsigned short startAddress) {
+    return new Assembler(nullptr, source, nullptr, Utils::empty, startAddress);
+}
 
-    if ((label.length() > 3) && (label.length() < 7)) {
-        std::string lab = label.substr(0, label.length() - 2);
-        std::string sufix = label.substr(label.length() - 2);
-        bool addrSufix = !sufix.compare("eq") || !sufix.compare("al") || !sufix.compare("gt") || !sufix.compare("ne");
+void Assembler::setOnePass(bool onePass) {
+    this->onePass = onePass;
+}
 
-        if (Assembler::reservedWords.find(lab) != Assembler::reservedWords.end()) {
-            return Assembler::reservedWords[lab] && addrSufix;
-        }
-    }
+void Assembler::setListing(bool listing) {
+    this->listing = listing;
+}
 
-    return false;
+void Assembler::setOptimize(bool optimize) {
+    this->optimize = optimize;
 }
-void Assembler::initStatic() {
-    Assembler::reservedWords["r0"] = 0;
-    Assembler::reservedWords["r1"] = 0;
-    Assembler::reservedWords["r2"] = 0;
-    Assembler::reservedWords["r3"] = 0;
-    Assembler::reservedWords["r4"] = 0;
-    Assembler::reservedWords["r5"] = 0;
-    Assembler::reservedWords["r6"] = 0;
-    Assembler::reservedWords["r7"] = 0;
-    Assembler::reservedWords["pc"] = 0;
-    Assembler::reservedWords["sp"] = 0;
-    Assembler::reservedWords["psw"] = 0;
-    Assembler::reservedWords["add"] = 1;
-    Assembler::reservedWords["sub"] = 1;
-    Assembler::reservedWords["mul"] = 1;
-    Assembler::reservedWords["div"] = 1;
-    Assembler::reservedWords["cmp"] = 1;
-    Assembler::reservedWords["and"] = 1;
-    Assembler::reservedWords["or"] = 1;
-    Assembler::reservedWords["not"] = 1;
-    Assembler::reservedWords["test"] = 1;
-    Assembler::reservedWords["push"] = 1;
-    Assembler::reservedWords["pop"] = 1;
-    Assembler::reservedWords["call"] = 1;
-    Assembler::reservedWords["iret"] = 1;
-    Assembler::reservedWords["mov"] = 1;
-    Assembler::reservedWords["shl"] = 1;
-    Assembler::reservedWords["shr"] = 1;
+
+void Assembler::setCache(ObjectCache* cache) {
+    this->cache = cache;
 }
 
 void Assembler::assemble() {
+    const std::string& listingFile = this->listing ? this->listingFile : Utils::empty;
+    CacheSource cached = {this->source, this->startAddress, this->optimize};
+    unsigned long long key = 0;
+
+    if (this->cache != nullptr) {
+        key = ObjectCache::key(cached);
+        if (this->cache->fetch(key, cached, this->object, listingFile)) {
+            this->writeObject();
+            return;
+        }
+    }
+
+    //Optimizer works on parsed text, so nothing is encoded in the first pass.
+    if (this->optimize) {
+        this->onePass = false;
+    }
+
+    Arena::Mark start = this->arena.mark();
+    this->deferLabels = this->onePass;
     this->firstPass();
-    this->secondPass();
+
+    //Source is parsed again with rewrites applied, which places every label and section anew.
+    //Removed code can bring a jump next to its target, so rounds go on until nothing changes.
+    //Every rewrite removes or shrinks a node, so this ends.
+    while (this->optimize && this->optimizeText()) {
+        this->reset(start);
+        this->firstPass();
+    }
+
+    if (this->onePass) {
+        this->resolveFixups();
+    }
+    else {
+        this->secondPass();
+    }
+
     this->cleanLocalSymbols();
+
     this->writeOutput();
-    this->writePrettyOutput();
-}
+    this->writeObject();
 
-void Assembler::cleanLocalSymbols() {
-    std::vector<std::string> toDelete;
+    if (!listingFile.empty()) {
+        this->writePrettyOutput();
+    }
+
+    if (this->cache != nullptr) {
+        this->cache->store(key, cached, this->object, listingFile);
+    }
+}
 
-    for(auto it = this->symbolTable.begin(); it != this->symbolTable.end(); ++it) {
-        if (it->second->isLocal() && (it->second->getSectionPtr() != nullptr))
-            toDelete.push_back(it->second->getName());
+void Assembler::writeObject() {
+    if (this->output != nullptr) {
+        this->output->write(this->object.data(), this->object.size());
     }
+}
 
-    for(int i = 0; i < toDelete.size(); ++i) {
-        this->symbolTable.erase(toDelete[i]);
+void Assembler::cleanLocalSymbols() {
+    for (unsigned int no = 0; no < this->symbolTable.indices(); ++no) {
+        Symbol* s = this->symbolTable.at(no);
+        if ((s != nullptr) && s->isLocal() && (s->getSectionPtr() != nullptr)) {
+            this->symbolTable.erase(s);
+        }
     }
 }
 
 Assembler::~Assembler() {
 
     //Closing streams.
-    this->input->close();
-    this->output->close();
-    this->objdumpOut->close();
-    //Deleting input stream.
+    if (this->output != nullptr) {
+        this->output->close();
+    }
+    //Unmapping input.
     delete this->input;
     this->input = nullptr;
 
     //Deleting output stream.
     delete this->output;
     this->output = nullptr;
-    
-    delete this->objdumpOut;
-    this->objdumpOut = nullptr;
-
-    for(auto it = this->symbolTable.begin(); it != this->symbolTable.end(); it++) {
-        if (it->second != nullptr) {
-            delete it->second;
-            it->second = nullptr;
-        } 
-    }
-        
-    for(auto it = this->instructions.begin(); it != this->instructions.end(); it++) {
-        if (it->second != nullptr) {
-            delete it->second;
-            it->second = nullptr;
-        } 
-    }
 
-    for(auto it = this->data.begin(); it != this->data.end(); it++) {
-        if (it->second != nullptr) {
-            delete it->second;
-            it->second = nullptr;
-        } 
-    } 
-    
-    for(auto it = this->roData.begin(); it != this->roData.end(); it++) {
-        if (it->second != nullptr) {
-            delete it->second;
-            it->second = nullptr;
-        } 
-    } 
-}
\ No newline at end of file
+
+    //Symbols and IR nodes are released with the arena.
+}
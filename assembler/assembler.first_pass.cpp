@@ -7,14 +7,18 @@
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
+#include <cstring>
 
 #include "assembler.h"
+#include "mapped_file.h"
 #include "utils.h"
 #include "string_tokenizer.h"
 #include "symbol.h"
 #include "ss_exceptions.h"
 #include "instruction.h"
 #include "operand.h"
+#include "lexer.h"
+#include "keywords.h"
 #include "section.h"
 #include "directive.h"
 #include "asm_declarations.h"
@@ -34,27 +38,36 @@ void Assembler::firstPass() {
     Section* currentSection = nullptr;
     
     bool end = false;
+
+    const char* text = this->source.data();
+    size_t size = this->source.size();
+    size_t position = 0;
     
-    while(std::getline(*(this->input),line)) {
+    while(position < size) {
+        const char* newline = (const char*)std::memchr(text + position, '\n', size - position);
+        size_t lineEnd = newline != nullptr ? newline - text : size;
+        StringView raw(text + position, lineEnd - position);
+        position = lineEnd + 1;
         ++lineNumber;
 
         //TODO: Ako je dosao kraj fajla a nije bilo .end-a mora da se prijavi greska.
-        if (line == "EOF") break;
+        if (raw == "EOF") break;
 
         //If line contains comments we need to remove them
-        size_t commentStart = line.find_first_of('#');
+        const char* commentStart = (const char*)std::memchr(raw.data(), '#', raw.size());
 
-        if (commentStart != std::string::npos) {
-            line = line.substr(0, commentStart);
+        if (commentStart != nullptr) {
+            raw = raw.substr(0, commentStart - raw.data());
         }
 
         //If line consist only of empty chars, loop is proceeding to the next line.
-        if (line.find_last_not_of(Utils::emptyChars) == std::string::npos) {
+        this->sourceLine = Utils::trim(raw);
+        if (this->sourceLine.empty() || (Utils::emptyChars.find(this->sourceLine[0]) != std::string::npos)) {
             continue;
         }
         
-        line = Utils::trim(line);
-        this->lines[lineNumber] = line;
+        //Line buffer is reused, so only lines longer than any before are allocated.
+        line.assign(this->sourceLine.data(), this->sourceLine.size());
         
         std::string newLine;
          
@@ -70,10 +83,10 @@ void Assembler::firstPass() {
                 throw AssemblingException(line.c_str(), lineNumber);
             }
 
-            std::string& token = st.nextToken();
-            SymbolTable::const_iterator it = this->symbolTable.find(token);
+            std::string token = st.nextToken().str();
+            Symbol* found = this->symbolTable.find(token);
             
-            if (Assembler::checkReserved(token)) {
+            if (Keywords::isReserved(token)) {
                 throw AssemblingException("Label name error, word " + token + " is reserved", line, lineNumber);
             }
 
@@ -81,8 +94,8 @@ void Assembler::firstPass() {
 
             //Checking if label was already defined. If it was defined in .global directive, we are only
             //changing it's entry in symbol table. If it was defined in some section, error is thrown.
-            if (it != this->symbolTable.end() && currentSection != nullptr) {
-                if (it->second->getSectionCode() == SectionType::UDF) {
+            if (found != nullptr && currentSection != nullptr) {
+                if (found->getSectionCode() == SectionType::UDF) {
                     undefined = true;
                 }
                 else {
@@ -93,30 +106,35 @@ void Assembler::firstPass() {
             }
             currentSection->increaseParsed();
             this->canAlign = false;
+            this->labelled = true;
+            Symbol* defined = nullptr;
             if (undefined) {
-                it->second->setSectionCode(currentSection->getSectionCode());
-                it->second->setSectionPtr(currentSection);
-                it->second->setOffset(locationCounter);
+                defined = found;
+                defined->setSectionCode(currentSection->getSectionCode());
+                defined->setSectionPtr(currentSection);
+                defined->setOffset(locationCounter);
             }
 
             else {
 
-                Symbol* s = new Symbol(token, currentSection ? currentSection->getSectionCode() : SectionType::UDF, locationCounter, true);
-                s->setSectionPtr(currentSection);
-                this->symbolTable[token] = s;
+                defined = this->arena.create<Symbol>(this->symbolCounter++, token, currentSection ? currentSection->getSectionCode() : SectionType::UDF, locationCounter, true);
+                defined->setSectionPtr(currentSection);
+                this->symbolTable.insert(defined);
+            }
+
+            if (!this->onePass && (currentSection->getSectionCode() == SectionType::TEXT)) {
+                this->setLabelNode(defined->getNo());
             }
             
             if (st.hasNext()) {
-                newLine = st.nextToken();
-                if (newLine.compare("") == 0) continue;
+                StringView rest = st.nextToken();
+                if (rest.empty()) continue;
                 else {
-                    if (st.hasNext()) {
-                        std::string junk = st.nextToken();
-                        if (junk.compare("") != 0) {
-                            throw AssemblingException("Syntax error", line, lineNumber);
-                        }
+                    if (st.hasNext() && !st.nextToken().empty()) {
+                        throw AssemblingException("Syntax error", line, lineNumber);
                     }
                 }
+                newLine = rest.str();
             }
             else {
                 continue;
@@ -128,8 +146,8 @@ void Assembler::firstPass() {
         }
         //===================================================================
         
-        newLine = Utils::trim(newLine);
-        newLine = Utils::removeRepeatingChars(newLine);
+        Utils::trim(newLine);
+        Utils::removeRepeatingChars(newLine);
         
          //If we read line that equals to .end, we reached end of file.
         if (newLine.compare(".end") == 0) {
@@ -140,16 +158,17 @@ void Assembler::firstPass() {
         //====================  Parsing section or variable declaration.    ========================
         if (newLine[0] == '.') {
             std::string directive = this->getDirective(newLine);
+            DirectiveCode code = Keywords::directive(directive);
             
             //Line contains .global directive
-            if (directive.compare(".global") == 0) {
+            if (code == GLOBAL_DIR) {
                 if (currentSection != nullptr) {
                     throw AssemblingException("Directive .global can only appear outside of section.", newLine, lineNumber);
                 } 
 
                 //Getting labels defined as global.
                 std::string params = this->getParameters(newLine);
-                StringTokenizer st = StringTokenizer(",");
+                StringTokenizer st(",");
                 
                 st.tokenize(params);
                 //.global directive must have at least one parameter
@@ -157,25 +176,25 @@ void Assembler::firstPass() {
                     throw AssemblingException("Unallowed use of directive .global (no parameters)", newLine, lineNumber);
                 }
                 while (st.hasNext()) {
-                    std::string param = st.nextToken();
-                    
-                    param = Utils::trim(param);
+                    StringView token = Utils::trim(st.nextToken());
 
                     //Checking if label name is valid
-                    if (std::regex_match(param, Utils::labelRegex)) {
+                    if (Lexer::isLabel(token)) {
+                        std::string param = token.str();
+
                         //Checking if label was already defined as global.
-                        if (this->symbolTable.find(param) != this->symbolTable.end()) {
+                        if (this->symbolTable.find(param) != nullptr) {
                               throw AssemblingException("ERROR: Symbol is already defined", newLine, lineNumber);
                         }
                         
                         //If all previous checks were succesfull, label can be added to symbol table.
-                        this->symbolTable[param] = new Symbol(param, SectionType::UDF, locationCounter, false);
+                        this->symbolTable.insert(this->arena.create<Symbol>(this->symbolCounter++, param, SectionType::UDF, locationCounter, false));
                     }
                 }
             }
             //Start of text section
-            else if (directive.compare(".text") == 0) {
-                if (this->symbolTable.find(directive) != this->symbolTable.end()) {
+            else if (code == TEXT_DIR) {
+                if (this->symbolTable.find(directive) != nullptr) {
                     throw AssemblingException("ERROR: Section .text was already defined, at line", line, lineNumber);
                 }
                 else {
@@ -184,8 +203,8 @@ void Assembler::firstPass() {
             }
             
             //Start of data section
-            else if (directive.compare(".data") == 0) {
-                 if (this->symbolTable.find(directive) != this->symbolTable.end()) {
+            else if (code == DATA_DIR) {
+                 if (this->symbolTable.find(directive) != nullptr) {
                     throw AssemblingException("ERROR: Section .data was already defined, at line", line, lineNumber);
                 }
                 else {
@@ -194,8 +213,8 @@ void Assembler::firstPass() {
             }
             
             //Start of rodata section
-            else if (directive.compare(".rodata") == 0) {
-                 if (this->symbolTable.find(directive) != this->symbolTable.end()) {
+            else if (code == RODATA_DIR) {
+                 if (this->symbolTable.find(directive) != nullptr) {
                     throw AssemblingException("ERROR: Section .rodata was already defined", line, lineNumber);
                 }
                 else {
@@ -204,8 +223,8 @@ void Assembler::firstPass() {
             }
             
             //Start of bss section
-            else if (directive.compare(".bss") == 0) {
-                 if (this->symbolTable.find(directive) != this->symbolTable.end()) {
+            else if (code == BSS_DIR) {
+                 if (this->symbolTable.find(directive) != nullptr) {
                     throw AssemblingException("ERROR: Section .bss was already defined", line, lineNumber);
                 }
                 else {
@@ -215,7 +234,23 @@ void Assembler::firstPass() {
             
             //Line contains directive like .char .word .long .skip or .align
             else {
-                this->parseDirective(newLine, directive, lineNumber, locationCounter, currentSection);
+                size_t start = locationCounter;
+                Arena::Mark mark = this->arena.mark();
+                Directive* d = this->parseDirective(newLine, directive, lineNumber, locationCounter, currentSection);
+
+                if (d != nullptr) {
+                    SourceNode<Directive> node = {d, lineNumber, this->sourceLine, false};
+                    if (this->onePass) {
+                        this->encodeDirective(d, currentSection, start, lineNumber, this->sourceLine);
+                        this->arena.rewind(mark);
+                    }
+                    else if (currentSection->getSectionCode() == SectionType::DATA) {
+                        this->data.push_back(node);
+                    }
+                    else {
+                        this->roData.push_back(node);
+                    }
+                }
             }
           
             this->canAlign = true;
@@ -229,13 +264,37 @@ void Assembler::firstPass() {
 
             if (currentSection->getSectionCode() == SectionType::TEXT) {
 
-                Instruction *i = new Instruction();
-                i->parseInstruction(newLine, lineNumber);
+                if (this->onePass) {
+                    //Instruction is encoded right away, labels it uses are patched at the end.
+                    Arena::Mark mark = this->arena.mark();
+                    Instruction i;
+                    i.parseInstruction(newLine, lineNumber, this->arena);
+
+                    size_t counter = locationCounter;
+                    this->encodeInstruction(&i, currentSection, counter, lineNumber, this->sourceLine);
+                    locationCounter = counter;
+                    this->arena.rewind(mark);
+                }
+                else {
+                    //Optimizer can drop or replace the instruction when the source is parsed again.
+                    const Rewrite* rewrite = this->textNodes < this->rewrites.size() ? &this->rewrites[this->textNodes] : nullptr;
+                    ++this->textNodes;
+
+                    if ((rewrite == nullptr) || !rewrite->drop) {
+                        Instruction *i = this->arena.create<Instruction>();
+                        i->parseInstruction(((rewrite != nullptr) && !rewrite->text.empty()) ? rewrite->text : newLine, lineNumber, this->arena);
+
+                        SourceNode<Instruction> node = {i, lineNumber, this->sourceLine, this->labelled};
+                        this->instructions.push_back(node);
+                        this->textIndex.push_back(this->textNodes - 1);
+                        locationCounter += i->getInstructionSize();
 
-                this->instructions[lineNumber] = i;
+                        //Label of a dropped node points to the next one.
+                        this->labelled = false;
+                    }
+                }
 
                 currentSection->increaseParsed();
-                locationCounter += i->getInstructionSize();
                 
                 this->canAlign = true;
             }
@@ -261,7 +320,7 @@ void Assembler::firstPass() {
     }
 }
 
-void Assembler::parseDirective(const std::string& line, const std::string& directive, const int lineNumber, int& locationCounter, Section* currentSection) {
+Directive* Assembler::parseDirective(const std::string& line, const std::string& directive, const int lineNumber, int& locationCounter, Section* currentSection) {
     
     size_t spacePos = line.find_first_of(" ");
 
@@ -274,20 +333,22 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
     }
     bool hasOps = ops.find_first_not_of(Utils::emptyChars) != std::string::npos;
 
+    DirectiveCode code = Keywords::directive(directive);
+
     bool skip = false;
     bool align = false;
     bool bwl = false;
-    if (directive.compare(".char") == 0) {
+    if (code == CHAR_DIR) {
         if (currentSection == nullptr ? true : (currentSection->getSectionCode() == SectionType::TEXT)) {
             throw AssemblingException("Directive .char not allowed in this section", line, lineNumber);
         }
         
         //locationCounter += 1;
 
-        d = new BWLDirective(DirectiveType::BYTE);
+        d = this->arena.create<BWLDirective>(DirectiveType::BYTE);
         bwl = true;
     }
-    else if (directive.compare(".word") == 0) {
+    else if (code == WORD_DIR) {
         if (currentSection == nullptr ? true : (currentSection->getSectionCode() == SectionType::TEXT)) {
             throw AssemblingException("Directive .word not allowed in this section", line, lineNumber);
         }
@@ -295,26 +356,26 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
         //locationCounter += 2;
        
         if (currentSection->getSectionCode() != SectionType::BSS)
-        d = new BWLDirective(DirectiveType::WORD);
+        d = this->arena.create<BWLDirective>(DirectiveType::WORD);
         bwl = true;
     }
-    else if (directive.compare(".long") == 0) {
+    else if (code == LONG_DIR) {
         if (currentSection == nullptr ? true : (currentSection->getSectionCode() == SectionType::TEXT)) {
             throw AssemblingException("Directive .long not allowed in this section", line, lineNumber);
         }
 
         //locationCounter += 4;
     
-        d = new BWLDirective(DirectiveType::LONG);
+        d = this->arena.create<BWLDirective>(DirectiveType::LONG);
         bwl = true;
     }
-    else if (directive.compare(".skip") == 0) {
+    else if (code == SKIP_DIR) {
 
         if (currentSection == nullptr ? true : (currentSection->getSectionCode() != SectionType::DATA && currentSection->getSectionCode() != SectionType::BSS)) {
             throw AssemblingException("Directive .skip not allowed in this section", line, lineNumber);
         }
         
-        if (!std::regex_match(ops, Operand::decimalRegex)) {
+        if (!Lexer::isDecimal(ops)) {
             throw AssemblingException("Invalid use of directive .skip", line, lineNumber);
         }
         
@@ -323,12 +384,12 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
         locationCounter += skip;
 
         if (currentSection->getSectionCode() == SectionType::DATA) {
-            d = new SkipDirective();
+            d = this->arena.create<SkipDirective>();
             ((SkipDirective*)d)->setOffset(skip);
         }
     }
     
-    else if (directive.compare(".align") == 0) {
+    else if (code == ALIGN_DIR) {
         if ((currentSection->getNParsed() != 0) && (currentSection->getSectionCode() == SectionType::TEXT)) {
             throw AssemblingException("Directive .align can only be written on the beggining of the text section.", line, lineNumber);
         }
@@ -336,7 +397,7 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
         if (!canAlign) {
             throw AssemblingException("Directive .aling cannot be written immediatly after label.", line, lineNumber);
         }
-        if (!std::regex_match(ops, Utils::decimalRegex)) {
+        if (!Lexer::isDecimal(ops)) {
             throw AssemblingException(".align invalid operand", line, lineNumber);
         }
 
@@ -350,12 +411,18 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
         switch(currentSection->getSectionCode()) {
             case SectionType::DATA:
             case SectionType::RO_DATA: { 
-                d = new AlignDirective(next - locationCounter);
+                d = this->arena.create<AlignDirective>(next - locationCounter);
                 break;
             }
             case SectionType::TEXT: {
-                Instruction *i = new Instruction(next - locationCounter);
-                this->instructions[lineNumber] = i;
+                if (this->onePass) {
+                    this->textBin.insert(this->textBin.end(), next - locationCounter, 0);
+                }
+                else {
+                    SourceNode<Instruction> node = {this->arena.create<Instruction>((size_t)(next - locationCounter)), lineNumber, this->sourceLine, false};
+                    this->instructions.push_back(node);
+                    this->textIndex.push_back(this->textNodes++);
+                }
                 break;
             }
             case SectionType::BSS: {
@@ -365,9 +432,12 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
         }
 
         locationCounter = next;
-        // unsigned int align = 1;
-        // align <<= pow;
-        // currentSection->setAlign(align);
+
+        //Linker keeps section addresses congruent modulo the largest alignment when moving it.
+        unsigned short align = 1 << pow;
+        if (align > currentSection->getAlign()) {
+            currentSection->setAlign(align);
+        }
     }
     else {
         throw AssemblingException("Unknown directive " + directive, line, lineNumber);
@@ -375,11 +445,11 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
     currentSection->increaseParsed();
 
     if (currentSection->getSectionCode() == SectionType::BSS) {
-        if (hasOps && (directive.compare(".skip") != 0)) {
+        if (hasOps && (code != SKIP_DIR)) {
             throw AssemblingException("Cannot initialize data in .bss section", line, lineNumber);
         }
         else {
-            return;
+            return nullptr;
         }
     }
 
@@ -388,25 +458,18 @@ void Assembler::parseDirective(const std::string& line, const std::string& direc
         st.tokenize(ops);
         BWLDirective* bwld = (BWLDirective*)d;
         while(st.hasNext()) {
-            std::string op = Utils::trim(st.nextToken());
-            if (!std::regex_match(op, Utils::labelRegex) && !std::regex_match(op, Utils::decimalRegex)) {
+            StringView op = Utils::trim(st.nextToken());
+            if (!Lexer::isLabel(op) && !Lexer::isDecimal(op)) {
                 throw AssemblingException("Invalid operand", line, lineNumber);
             }
 
-            bwld->setOperand(op);
+            bwld->setOperand(op.str());
         }
         char multiplicator = bwld->getType() == DirectiveType::BYTE ? 1 : bwld->getType() == DirectiveType::WORD ? 2 : 4;
         locationCounter += bwld->getOperands().size() * multiplicator;
     }
 
-    if (d != nullptr) {
-        if (currentSection->getSectionCode() == SectionType::DATA) {
-            this->data[lineNumber] = d;
-        }
-        if (currentSection->getSectionCode() == SectionType::RO_DATA) {
-            this->roData[lineNumber] = d;
-        }
-    }
+    return d;
 }
 
 void Assembler::changeSection(const std::string& sectionName, SectionType sectionType, Access access, int locationCounter, Section*& previousSection, Section*& currentSection) {
@@ -418,43 +481,34 @@ void Assembler::changeSection(const std::string& sectionName, SectionType sectio
         previousSection->setSectionSize(sectionSize);
     }
 
-    Symbol* s = new Section(0, access, sectionName, sectionType, locationCounter, true);
+    Symbol* s = this->arena.create<Section>(this->symbolCounter++, 0, access, sectionName, sectionType, locationCounter, true);
     
     currentSection = (Section*)s;
 
     
-    this->symbolTable[sectionName] = s;
+    this->symbolTable.insert(s);
     this->sectionOrder[sectionCounter++] = sectionType;
 }
 
 std::string Assembler::getParameters(const std::string line) {
     
-    std::string formatted(line); 
-    formatted = Utils::trim(formatted);
+    StringView formatted = Utils::trim(StringView(line));
     
-    size_t spacePos = formatted.find_first_of(' ');
-    if (spacePos == std::string::npos) {
+    size_t spacePos = 0;
+    while ((spacePos < formatted.size()) && (formatted[spacePos] != ' ')) ++spacePos;
+    if (spacePos == formatted.size()) {
         return "";
     }
     
-    formatted = formatted.substr(spacePos + 1);
-    return Utils::trim(formatted);
+    return Utils::trim(formatted.substr(spacePos + 1)).str();
 }
 
 std::string Assembler::getDirective(const std::string line) const {
-    if (line[0] != '.') {
+    Token directive = Lexer::directive(line);
+
+    if (directive.type != DIRECTIVE_TOKEN) {
         return Utils::empty;
     }
     
-    
-    if (line.find_first_not_of(Utils::emptyChars) == std::string::npos) {
-        return Utils::empty;    
-    }
-    
-    
-    std::string newLine = Utils::trim(line);
-    size_t spacePos = newLine.find_first_of(' ');
-    
-    return newLine.substr(0, spacePos);
- 
+    return directive.text.str();
 }
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include <string>
+#include <vector>
+
+#include "assembler.h"
+#include "symbol.h"
+#include "instruction.h"
+#include "operand.h"
+#include "asm_declarations.h"
+
+using namespace ss;
+
+//Flags of psw, as the emulator sets them.
+#define FLAG_Z 0x0001
+#define FLAG_O 0x0002
+#define FLAG_C 0x0004
+#define FLAG_N 0x0008
+#define ALL_FLAGS 0xFFFF
+
+#define PC_REGISTER 7
+#define SP_REGISTER 6
+
+#define NO_NODE ((size_t)-1)
+
+namespace {
+
+    bool isRegister(const Operand* op, int& reg) {
+        if ((op == nullptr) || (op->getType() != OperandType::REGDIR_VAL)) {
+            return false;
+        }
+        reg = op->getRawText()[1] - '0';
+        return true;
+    }
+
+    bool isRegisterNumber(const Operand* op, int reg) {
+        int number;
+        return isRegister(op, number) && (number == reg);
+    }
+
+    bool isConstant(const Operand* op, int& value) {
+        if ((op == nullptr) || (op->getType() != OperandType::IMMED_VAL)) {
+            return false;
+        }
+        value = std::stoi(op->getRawText());
+        return true;
+    }
+
+    bool hasPsw(const Instruction* i) {
+        return ((i->getOperand1() != nullptr) && (i->getOperand1()->getType() == OperandType::PSW))
+            || ((i->getOperand2() != nullptr) && (i->getOperand2()->getType() == OperandType::PSW));
+    }
+
+    //Operand that can be read anywhere with the same result and no side effects.
+    bool isPlainSource(const Operand* op) {
+        int reg;
+        if (isRegister(op, reg)) {
+            return (reg != PC_REGISTER) && (reg != SP_REGISTER);
+        }
+        return (op->getType() == OperandType::IMMED_VAL) || (op->getType() == OperandType::LABEL_VAL);
+    }
+
+    //Instruction of two operands that stores result to the first one.
+    bool storesResult(InstructionCode code) {
+        switch (code) {
+            case ADD: case SUB: case MUL: case DIV:
+            case AND: case OR: case NOT:
+            case MOV: case SHL: case SHR:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    unsigned int flagsRead(const Instruction* i) {
+        if (hasPsw(i)) {
+            return ALL_FLAGS;
+        }
+
+        switch (i->getCondition()) {
+            case EQ: case NE: return FLAG_Z;
+            case GT: return FLAG_N;
+            default: return 0;
+        }
+    }
+
+    //Flags instruction writes when it is executed.
+    unsigned int flagsSet(InstructionCode code) {
+        switch (code) {
+            case ADD: case SUB: case CMP: case ADD_JMP:
+                return FLAG_Z | FLAG_N | FLAG_O | FLAG_C;
+            case MUL: case DIV: case AND: case OR: case NOT: case TEST: case MOV:
+                return FLAG_Z | FLAG_N;
+            case SHL: case SHR:
+                return FLAG_Z | FLAG_N | FLAG_C;
+            case IRET:
+                return ALL_FLAGS;
+            default:
+                return 0;
+        }
+    }
+
+    //Flags that are always written, conditional instructions may leave all of them.
+    unsigned int flagsWritten(const Instruction* i) {
+        return i->getCondition() == ConditionCode::AL ? flagsSet(i->getInstruciton()) : 0;
+    }
+
+    //Jumps, calls and returns, where execution goes on is not known here.
+    bool changesFlow(const Instruction* i) {
+        InstructionCode code = i->getInstruciton();
+        if ((code == CALL) || (code == IRET) || (code == ADD_JMP)) {
+            return true;
+        }
+        return (storesResult(code) || (code == POP)) && isRegisterNumber(i->getOperand1(), PC_REGISTER);
+    }
+
+    std::string mnemonic(const Instruction* i, const std::string& base) {
+        switch (i->getCondition()) {
+            case EQ: return base + "eq";
+            case NE: return base + "ne";
+            case GT: return base + "gt";
+            default: return base;
+        }
+    }
+
+    //Same loop as emulator runs, so the folded value and flags match.
+    short shift(short value, int count, bool left) {
+        for (int i = 0; (i < count) && (i < 16); ++i) {
+            if (left) {
+                value <<= 1;
+            }
+            else {
+                value >>= 1;
+            }
+        }
+        return value;
+    }
+}
+
+void Assembler::reset(const Arena::Mark& start) {
+    this->symbolTable.clear();
+    this->instructions.clear();
+    this->data.clear();
+    this->roData.clear();
+
+    for (int i = 0; i < SECTION_NUMBER; ++i) {
+        this->sectionOrder[i] = SectionType::UDF;
+    }
+    this->sectionCounter = 0;
+    this->symbolCounter = 0;
+    this->textNodes = 0;
+    this->textIndex.clear();
+    this->labelNodes.clear();
+    this->canAlign = true;
+    this->labelled = false;
+
+    this->arena.rewind(start);
+}
+
+//Every rewrite keeps the flags that are read later, and a node reached by a jump is never
+//merged into the one before it. Flags are live after a jump, call or return, because it is not
+//known which code runs next. Jump targets are found by the text node their label points to.
+bool Assembler::optimizeText() {
+    std::vector<SourceNode<Instruction>>& text = this->instructions;
+    size_t count = text.size();
+
+    //Flags that may be read after and before every instruction, the one past the end reads all of them.
+    std::vector<unsigned int> liveAfter(count);
+    std::vector<unsigned int> liveBefore(count + 1);
+    liveBefore[count] = ALL_FLAGS;
+    for (size_t k = count; k-- > 0;) {
+        const Instruction* i = text[k].node;
+        if (i->getInstruciton() == InstructionCode::ALIGN_INST) {
+            liveAfter[k] = liveBefore[k] = ALL_FLAGS;
+            continue;
+        }
+
+        liveAfter[k] = changesFlow(i) ? ALL_FLAGS : liveBefore[k + 1];
+        liveBefore[k] = flagsRead(i) | (liveAfter[k] & ~flagsWritten(i));
+    }
+
+    if (this->rewrites.empty()) {
+        this->rewrites.assign(this->textNodes, Rewrite());
+    }
+    bool changed = false;
+
+    for (size_t k = 0; k < count; ++k) {
+        const Instruction* i = text[k].node;
+        InstructionCode code = i->getInstruciton();
+        if ((code == InstructionCode::ALIGN_INST) || hasPsw(i)) {
+            continue;
+        }
+
+        Operand* dst = i->getOperand1();
+        Operand* src = i->getOperand2();
+        int reg = 0, other = 0, value = 0, next = 0;
+
+        //Jump to register needs no second word.
+        if ((code == MOV) && (i->getInstructionSize() == 4) && isRegisterNumber(dst, PC_REGISTER) && isRegister(src, reg)) {
+            this->rewrites[this->textIndex[k]].text = mnemonic(i, "mov") + " r7, " + src->getRawText();
+            changed = true;
+            continue;
+        }
+
+        //Jump to the next node only sets flags, whether it is taken or not.
+        if (((code == MOV) || (code == ADD_JMP)) && isRegisterNumber(dst, PC_REGISTER)
+            && ((src->getType() == OperandType::LABEL_VAL) || (src->getType() == OperandType::PCREL_VAL))) {
+            size_t target = NO_NODE;
+            Symbol* label = this->symbolTable.find(StringView(src->getRawText()).substr(1));
+            if ((label != nullptr) && (label->getNo() < this->labelNodes.size())) {
+                target = this->labelNodes[label->getNo()];
+            }
+
+            if ((target == k + 1) && !(liveBefore[k + 1] & flagsSet(code))) {
+                this->rewrites[this->textIndex[k]].drop = true;
+                changed = true;
+                continue;
+            }
+        }
+
+        //Moving register to itself only sets Z and N.
+        if ((code == MOV) && isRegister(dst, reg) && isRegisterNumber(src, reg) && !(liveAfter[k] & (FLAG_Z | FLAG_N))) {
+            this->rewrites[this->textIndex[k]].drop = true;
+            changed = true;
+            continue;
+        }
+
+        //Zero shift sets Z and N and clears C.
+        if (((code == SHL) || (code == SHR)) && isRegister(dst, reg) && isConstant(src, value) && (value == 0)
+            && !(liveAfter[k] & (FLAG_Z | FLAG_N | FLAG_C))) {
+            this->rewrites[this->textIndex[k]].drop = true;
+            changed = true;
+            continue;
+        }
+
+        //Rest of rewrites merge two unconditional instructions.
+        if ((k + 1 >= count) || text[k + 1].labelled || (i->getCondition() != ConditionCode::AL)) {
+            continue;
+        }
+
+        const Instruction* j = text[k + 1].node;
+        InstructionCode nextCode = j->getInstruciton();
+        if ((nextCode == InstructionCode::ALIGN_INST) || (j->getCondition() != ConditionCode::AL) || hasPsw(j)) {
+            continue;
+        }
+
+        Operand* nextDst = j->getOperand1();
+        Operand* nextSrc = j->getOperand2();
+        bool merged = false;
+
+        if ((code == MOV) && (nextCode == MOV) && isRegister(dst, reg) && (reg != PC_REGISTER) && (reg != SP_REGISTER)) {
+            //Moving value back, flags are the same as after the first move.
+            if (isPlainSource(src) && isRegister(src, other) && isRegisterNumber(nextDst, other) && isRegisterNumber(nextSrc, reg)) {
+                this->rewrites[this->textIndex[k + 1]].drop = true;
+                merged = true;
+            }
+            //Value is overwritten before it is used.
+            else if (isRegisterNumber(nextDst, reg) && isPlainSource(src) && isPlainSource(nextSrc) && !isRegisterNumber(nextSrc, reg)) {
+                this->rewrites[this->textIndex[k]].drop = true;
+                merged = true;
+            }
+        }
+
+        //Push followed by pop moves the value through the stack.
+        else if ((code == PUSH) && (nextCode == POP) && isPlainSource(dst) && isRegister(nextDst, reg) && (reg != SP_REGISTER)) {
+            if (isRegisterNumber(dst, reg)) {
+                this->rewrites[this->textIndex[k]].drop = true;
+                this->rewrites[this->textIndex[k + 1]].drop = true;
+                merged = true;
+            }
+            else if (!(liveAfter[k + 1] & (FLAG_Z | FLAG_N))) {
+                this->rewrites[this->textIndex[k]].text = "mov " + nextDst->getRawText() + ", " + dst->getRawText();
+                this->rewrites[this->textIndex[k + 1]].drop = true;
+                merged = true;
+            }
+        }
+
+        else if (((code == SHL) || (code == SHR)) && (nextCode == code) && isRegister(dst, reg) && (reg != PC_REGISTER)
+                 && isRegisterNumber(nextDst, reg) && isConstant(src, value) && isConstant(nextSrc, next)) {
+            //Bits are shifted out one by one, so C is the last bit shifted out either way.
+            if ((value > 0) && (next > 0) && (value + next <= 16)) {
+                this->rewrites[this->textIndex[k]].text = mnemonic(i, code == SHL ? "shl" : "shr") + " " + dst->getRawText() + ", " + std::to_string(value + next);
+                this->rewrites[this->textIndex[k + 1]].drop = true;
+                merged = true;
+            }
+        }
+
+        //Constant is shifted here, the move sets Z and N of the result, but not C.
+        else if ((code == MOV) && ((nextCode == SHL) || (nextCode == SHR)) && isRegister(dst, reg) && (reg != PC_REGISTER)
+                 && isConstant(src, value) && isRegisterNumber(nextDst, reg) && isConstant(nextSrc, next) && !(liveAfter[k + 1] & FLAG_C)) {
+            short result = shift((short)value, (unsigned short)next, nextCode == SHL);
+            this->rewrites[this->textIndex[k]].text = "mov " + dst->getRawText() + ", " + std::to_string(result);
+            this->rewrites[this->textIndex[k + 1]].drop = true;
+            merged = true;
+        }
+
+        if (merged) {
+            changed = true;
+            ++k;
+        }
+    }
+
+    return changed;
+}
+
+void Assembler::setLabelNode(unsigned int no) {
+    if (no >= this->labelNodes.size()) {
+        this->labelNodes.resize(no + 1, NO_NODE);
+    }
+    this->labelNodes[no] = this->instructions.size();
+}
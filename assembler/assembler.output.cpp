@@ -23,7 +23,35 @@
 
 using namespace ss;
 
+//Listing is made from the binaries and relocation tables only when it is requested.
+void Assembler::writeBytes(std::ostream& out, const std::string& header, const std::vector<char>& bin) {
+    out << header << '\n' << std::hex << std::setfill('0');
+    for (size_t i = 0; i < bin.size(); ++i) {
+        out << std::setw(2) << ((int)bin[i] & 0xFF) << ' ';
+    }
+    out << std::dec << std::endl;
+}
+
+void Assembler::writeRelocations(std::ostream& out, const std::string& header, const std::vector<Relocation>& relocations) {
+    out << header << std::endl 
+        << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "offset" 
+        << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "tip" 
+        << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "vr" << std::endl; 
+
+    for (auto& rel: relocations) {
+        out << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << std::hex << rel.offset 
+            << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << (rel.type == RelocationType::R_386_PC16 ? "R_386_PC16" : "R_386_16")
+            << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << rel.id << std::dec << std::endl;
+    }
+}
+
 void Assembler::writePrettyOutput() {
+    std::ofstream out(this->listingFile, std::ofstream::out | std::ofstream::trunc);
+
+    if (!out.is_open()) {
+        throw AssemblingException("Cannot open file " + this->listingFile);
+    }
+
     bool hasText = false;
     bool hasRoData = false;
     bool hasData = false;
@@ -40,60 +68,39 @@ void Assembler::writePrettyOutput() {
     }
 
     if (hasText) {
-        *this->objdumpOut << this->textOut << std::endl;
+        this->writeBytes(out, "#text", this->textBin);
     }
     if (hasRoData) {
-        *this->objdumpOut << this->roDataOut << std::endl;
+        this->writeBytes(out, "#rodata", this->roDataBin);
     }
     if (hasData) {
-        *this->objdumpOut << this->dataOut << std::endl;
+        this->writeBytes(out, "#data", this->dataBin);
     }
 
     if (this->symbolTable.size() != 0) {
-        *this->objdumpOut << "#symbol table" << std::endl << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "#name" << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) 
+        out << "#symbol table" << std::endl << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "#name" << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) 
                                                       << "section" << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) 
                                                       << "value" << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH)
                                                       << "size" << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH)  
                                                       << "access" << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH)   
                                                       << "no" << std::endl;
 
-        for(auto it = this->symbolTable.begin(); it != this->symbolTable.end(); ++it) {
-            Symbol *s = it->second;
-            
+        for (Symbol* s: this->symbolTable.sortedByName()) {
             std::string symbStr = s->toString();
-            *this->objdumpOut << symbStr << std::endl;
+            out << symbStr << std::endl;
         }
     }
     
-    if (hasText && this->txtRelText.size() != 0) {
-        *this->objdumpOut << "#.ret.text" << std::endl 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "offset" 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "tip" 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "vr" << std::endl; 
-
-        for(auto line:this->txtRelText) {
-            *this->objdumpOut << line << std::endl;
-        }
+    if (hasText && this->relText.size() != 0) {
+        this->writeRelocations(out, "#.ret.text", this->relText);
     }
 
-    if (hasRoData && this->txtRelROData.size() != 0) {
-        *this->objdumpOut << "#.ret.rodata" << std::endl 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "offset" 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "tip" 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "vr" << std::endl; 
-        for(auto line:this->txtRelROData) {
-            *this->objdumpOut << line << std::endl;
-        }
+    if (hasRoData && this->relROData.size() != 0) {
+        this->writeRelocations(out, "#.ret.rodata", this->relROData);
     }
 
-    if (hasData && this->txtRelData.size() != 0) {
-        *this->objdumpOut << "#.ret.data" << std::endl 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "offset" 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "tip" 
-                      << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << "vr" << std::endl;  
-        for(auto line:this->txtRelData) {
-            *this->objdumpOut << line << std::endl;
-        }
+    if (hasData && this->relData.size() != 0) {
+        this->writeRelocations(out, "#.ret.data", this->relData);
     }
 
 }
@@ -134,7 +141,7 @@ void Assembler::writeOutput() {
                 throw AssemblingException("Section text exceeds maximum allowed size.");
             }
 
-            Section *s = (Section*)this->symbolTable[".text"];
+            Section *s = (Section*)this->symbolTable.find(".text");
 
             sectionHds[sectionHdNum] = SectionHeader(s->getSectionCode(), s->getAccessRights(), currentOffset, (ElfWord)size, s->getAlign(), 0);
 
@@ -153,7 +160,7 @@ void Assembler::writeOutput() {
                 throw AssemblingException("Section rodata exceeds maximum allowed size.");
             }
 
-            Section *s = (Section*)this->symbolTable[".rodata"];
+            Section *s = (Section*)this->symbolTable.find(".rodata");
 
             sectionHds[sectionHdNum] = SectionHeader(s->getSectionCode(), s->getAccessRights(), currentOffset, (ElfWord)size, s->getAlign(), 0);
 
@@ -171,7 +178,7 @@ void Assembler::writeOutput() {
                 throw AssemblingException("Section data exceeds maximum allowed size.");
             }
 
-            Section *s = (Section*)this->symbolTable[".data"];
+            Section *s = (Section*)this->symbolTable.find(".data");
 
             sectionHds[sectionHdNum] = SectionHeader(s->getSectionCode(), s->getAccessRights(), currentOffset, (ElfWord)size, s->getAlign(), 0);
             
@@ -184,7 +191,7 @@ void Assembler::writeOutput() {
             hasData = true;
         }
         if (this->sectionOrder[i] == SectionType::BSS) {
-            Section *s = (Section*)this->symbolTable[".bss"];
+            Section *s = (Section*)this->symbolTable.find(".bss");
             size_t size = s->getSectionSize();
             bssSize = size;
             if (size > maxSecSize) {
@@ -227,15 +234,16 @@ void Assembler::writeOutput() {
     }
 
     std::vector<SymTabEntry> symTabEntries;
-    std::vector<std::string> symTabNames;
-    ElfWord strTabSize = 0;
-    ElfWord symCnt = 0;
+    std::vector<char> strTab;
     hasSymTab = this->symbolTable.size() != 0;
 
-    //Writting symbol table
-    for(auto it = this->symbolTable.begin(); it != this->symbolTable.end(); ++it) {
+    //Writting symbol table, symbols are walked by number, so entries are ordered by id.
+    for (unsigned int no = 0; no < this->symbolTable.indices(); ++no) {
 
-        Symbol* s = it->second;
+        Symbol* s = this->symbolTable.at(no);
+        if (s == nullptr) {
+            continue;
+        }
         
         ElfWord offset;
         #ifdef RELATIVE_OFFSET
@@ -250,30 +258,11 @@ void Assembler::writeOutput() {
         #endif
         
 
-        symTabEntries.push_back(SymTabEntry(symCnt, offset, s->getSectionCode(), s->getNo()));
-        symTabNames.push_back(s->getName());
-        size_t size = sizeof(int) + s->getName().length();
-        strTabSize += (ElfWord)(size); 
-        symCnt++;
-    }
+        symTabEntries.push_back(SymTabEntry((ElfWord)symTabEntries.size(), offset, s->getSectionCode(), s->getNo()));
 
-    //Sorting symbolTable
-    for (int i = 0; i < symTabEntries.size() - 1; ++i) {
-        for(int j = i + 1; j < symTabEntries.size(); ++j) {
-            if (symTabEntries[j] < symTabEntries[i]) {
-                SymTabEntry s = symTabEntries[i];
-                symTabEntries[i] = symTabEntries[j];
-                symTabEntries[j] = s;
-
-                std::string str = symTabNames[i];
-                symTabNames[i] = symTabNames[j];
-                symTabNames[j] = str;
-            }
-        }
-    }
-
-    for (int i = 0; i < symTabEntries.size(); i++) {
-        symTabEntries[i].name = i;
+        //Name is copied from the intern pool, which is in string table format.
+        StringView name = this->symbolTable.stringTableEntry(no);
+        strTab.insert(strTab.end(), name.begin(), name.end());
     }
 
     sectionHds[sectionHdNum] = SectionHeader(SectionType::SYMB_TAB, Access::RD, currentOffset, (ElfWord)(symTabEntries.size() * sizeof(SymTabEntry)), 0, sizeof(SymTabEntry));
@@ -309,7 +298,7 @@ void Assembler::writeOutput() {
     }
 
     //Writting string table section
-    sectionHds[sectionHdNum] = SectionHeader(SectionType::STR_TAB, Access::RD, currentOffset, strTabSize, 0, 0);
+    sectionHds[sectionHdNum] = SectionHeader(SectionType::STR_TAB, Access::RD, currentOffset, (ElfWord)strTab.size(), 0, 0);
     currentOffset += sectionHds[sectionHdNum].size;
     hasStrTab = true;
     ++sectionHdNum;
@@ -323,72 +312,49 @@ void Assembler::writeOutput() {
     header.shEntSize = sizeof(SectionHeader);
     header.shNum = sectionHdNum;
 
-    this->output->write((char*)&header, sizeof(ELFHeader)); 
-    //std::cout  << this->output->tellp() << std::flush;
+    //Object is assembled in memory and written at once.
+    std::vector<char>& buffer = this->object;
+    buffer.clear();
+    buffer.reserve(currentOffset + sizeof(SectionHeader) * sectionHdNum);
+    auto append = [&buffer](const void* data, size_t size) {
+        buffer.insert(buffer.end(), (const char*)data, (const char*)data + size);
+    };
+
+    append(&header, sizeof(ELFHeader));
     for(int i = 0; i < SECTION_NUMBER && this->sectionOrder[i] != SectionType::UDF; ++i) {
         if (this->sectionOrder[i] == SectionType::TEXT) {
-            this->output->write(&this->textBin[0], this->textBin.size() * sizeof(char)); 
-            //std::cout  << this->output->tellp() << std::endl <<std::flush;
+            append(this->textBin.data(), this->textBin.size());
         }
         if (this->sectionOrder[i] == SectionType::RO_DATA) {
-            this->output->write(&this->roDataBin[0], this->roDataBin.size() * sizeof(char));
-            //std::cout  << this->output->tellp() << std::endl <<std::flush;
+            append(this->roDataBin.data(), this->roDataBin.size());
         }
         if (this->sectionOrder[i] == SectionType::DATA) {
-            this->output->write(&this->dataBin[0], this->dataBin.size() * sizeof(char)); 
-            //std::cout  << this->output->tellp() << std::endl <<std::flush;
+            append(this->dataBin.data(), this->dataBin.size());
         }
         if (this->sectionOrder[i] == SectionType::BSS) {
-            char* bss = new char[bssSize];
-            this->output->write(&bss[0], bssSize);
-            delete[] bss;
-            //std::cout  << this->output->tellp() <<std::endl << std::flush;
+            buffer.insert(buffer.end(), bssSize, 0);
         }
     }
 
-    // if (hasText) {
-    //     this->output->write(&this->textBin[0], this->textBin.size() * sizeof(char)); 
-    // }
-
-    // if (hasRoData) {
-    //     this->output->write(&this->roDataBin[0], this->roDataBin.size() * sizeof(char)); 
-    // }
-
-    // if (hasData) {
-    //     this->output->write(&this->dataBin[0], this->dataBin.size() * sizeof(char)); 
-    // }
-
     if (hasSymTab) {
-        this->output->write((char*)&symTabEntries[0], sizeof(SymTabEntry) * symTabEntries.size());
-        //std::cout  << this->output->tellp() << std::endl <<std::flush;
+        append(symTabEntries.data(), sizeof(SymTabEntry) * symTabEntries.size());
     }
 
     if (hasRelText) {
-        this->output->write((char*)&this->relText[0], sizeof(Relocation) * this->relText.size());
-        //std::cout  << this->output->tellp() <<std::endl << std::flush;
+        append(this->relText.data(), sizeof(Relocation) * this->relText.size());
     }
 
     if (hasRelROData) {
-        this->output->write((char*)&this->relROData[0], sizeof(Relocation) * this->relROData.size());
-           // std::cout  << this->output->tellp() <<std::endl << std::flush;
+        append(this->relROData.data(), sizeof(Relocation) * this->relROData.size());
     }
 
     if (hasRelData) {
-        this->output->write((char*)&this->relData[0], sizeof(Relocation) * this->relData.size());
-           // std::cout  << this->output->tellp() <<std::endl << std::flush;
+        append(this->relData.data(), sizeof(Relocation) * this->relData.size());
     }
 
     if (hasStrTab) {
-        for(int i = 0; i < symTabNames.size(); ++i) {
-            unsigned int sz = symTabNames[i].length();
-
-            this->output->write((char*)&sz, sizeof(int));
-            this->output->write((char*)&symTabNames[i][0], sz);
-            //std::cout  << this->output->tellp() << std::endl << std::flush;
-        }
+        append(strTab.data(), strTab.size());
     }
 
-    //std::cout  << this->output->tellp() << std::flush;
-    this->output->write((char*)&sectionHds[0], sizeof(SectionHeader) * sectionHdNum);
-    
-}
\ No newline at end of file
+    append(&sectionHds[0], sizeof(SectionHeader) * sectionHdNum);
+}
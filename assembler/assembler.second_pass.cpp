@@ -15,6 +15,7 @@
 #include "ss_exceptions.h"
 #include "instruction.h"
 #include "operand.h"
+#include "lexer.h"
 #include "section.h"
 #include "directive.h"
 #include "asm_declarations.h"
@@ -27,19 +28,17 @@ using namespace ss;
 void Assembler::secondPass() {
     Section* currentSection = nullptr;
     size_t locationCounter = this->startAddress;
-    unsigned int lineNumber = 0;
 
     for (char i = 0; (i < SECTION_NUMBER) && (this->sectionOrder[i] != SectionType::UDF); ++i) {
         std::string sectionName = this->sectionOrder[i] == SectionType::TEXT ? ".text" :
             this->sectionOrder[i] == SectionType::DATA ? ".data" :
             this->sectionOrder[i] == SectionType::RO_DATA ? ".rodata" : ".bss";
         
-        currentSection = (Section*)this->symbolTable[sectionName];
+        currentSection = (Section*)this->symbolTable.find(sectionName);
 
         switch(this->sectionOrder[i]) {
             case SectionType::TEXT: {
                 this->assembleTextSection(currentSection, locationCounter);
-                //std::cout << this->textOut;
                 break;
             }
             case SectionType::DATA: {
@@ -60,256 +59,179 @@ void Assembler::secondPass() {
 }
 
 void Assembler::assembleTextSection(Section* current, size_t& locationCounter) {
-    
-    std::stringstream relStream;
-             
-    relStream << "#text\n";
-    
-    for (auto it = this->instructions.begin(); it != this->instructions.end(); ++it) {
-        Instruction* instr = it->second;
-
-        if (instr->getInstruciton() == InstructionCode::ALIGN_INST) {
-            int size = instr->getInstructionSize();
-            short byte = 0;
-            for (int i = 0; i < size; i++) {
-                relStream << "00 "; 
-                
-                this->textBin.push_back((char)byte);
-            }
-            locationCounter = size;
-            continue;
-        }
-
-        //First two and potential second two bytes of instruction
-        short firstHalf = 0, secondHalf = 0;
-        locationCounter += instr->getInstructionSize();
+    for (auto& i: this->instructions) {
+        this->encodeInstruction(i.node, current, locationCounter, i.lineNumber, i.line);
+    }
+}
 
-        //Writting condition code to the first part of instruction
-        const short condCode =(short) instr->getCondition();
-        firstHalf |= condCode << CONDITION_FLAGS_OFFSET;
+void Assembler::encodeInstruction(Instruction* instr, Section* current, size_t& locationCounter, const int lineNumber, StringView line) {
+    if (instr->getInstruciton() == InstructionCode::ALIGN_INST) {
+        int size = instr->getInstructionSize();
+        short byte = 0;
+        for (int i = 0; i < size; i++) {
+            this->textBin.push_back((char)byte);
+        }
+        locationCounter += size;
+        return;
+    }
 
-        //Writting instruction code
-        const short instrCode = (instr->getInstruciton() != InstructionCode::ADD_JMP ? instr->getInstruciton() : InstructionCode::ADD);
-        firstHalf |= instrCode << INSTRUCTION_FLAGS_OFFSET;
+    //First two and potential second two bytes of instruction
+    short firstHalf = 0, secondHalf = 0;
+    locationCounter += instr->getInstructionSize();
 
+    //Writting condition code to the first part of instruction
+    const short condCode =(short) instr->getCondition();
+    firstHalf |= condCode << CONDITION_FLAGS_OFFSET;
 
-        if (Instruction::operandNumber[instr->getInstruciton()] != 0) {      
+    //Writting instruction code
+    const short instrCode = (instr->getInstruciton() != InstructionCode::ADD_JMP ? instr->getInstruciton() : InstructionCode::ADD);
+    firstHalf |= instrCode << INSTRUCTION_FLAGS_OFFSET;
 
-            //Getting first operand            
-            Operand* op1 = instr->getOperand1();
-            auto op1Addr = op1->getAddressing();
 
-            //Only call is allowed to have first operand provided with immediate addressing.
-            if ((op1->getAddressing() == AddressingCode::IMMED) && (instr->getInstruciton() != InstructionCode::CALL) && (op1->getType() != OperandType::PSW) && (instr->getInstruciton() != InstructionCode::PUSH)) {
-                std::string line = this->lines[it->first];
-                throw AssemblingException("Addressing error, immediate operand cannot be destination", line, it->first);
-            }
+    if (Instruction::operandNumber[instr->getInstruciton()] != 0) {      
 
-            //Writting addressing flags
-            short addrCode = op1Addr;
-            firstHalf |= addrCode << (((instr->getInstruciton() == PUSH) || (instr->getInstruciton() == CALL)) ? OP2_ADDRESSING_FLAGS_OFFSET : OP1_ADDRESSING_FLAGS_OFFSET);
+        //Getting first operand            
+        Operand* op1 = instr->getOperand1();
+        auto op1Addr = op1->getAddressing();
 
-            char op1Flags = this->getOperandCode(op1, current, instr, locationCounter, secondHalf, it->first);
-
-            if ((instr->getInstruciton() == PUSH) || (instr->getInstruciton() == CALL)) {
-                firstHalf |= op1Flags;
-            }
-            else {
-                firstHalf |= op1Flags << 5;
-            }
+        //Only call is allowed to have first operand provided with immediate addressing.
+        if ((op1->getAddressing() == AddressingCode::IMMED) && (instr->getInstruciton() != InstructionCode::CALL) && (op1->getType() != OperandType::PSW) && (instr->getInstruciton() != InstructionCode::PUSH)) {
+            throw AssemblingException("Addressing error, immediate operand cannot be destination", line.str(), lineNumber);
+        }
 
-            Operand* op2 = instr->getOperand2();
-            
-            if (op2 != nullptr) {
-                auto op2Addr = op2->getAddressing();
+        //Writting addressing flags
+        short addrCode = op1Addr;
+        firstHalf |= addrCode << (((instr->getInstruciton() == PUSH) || (instr->getInstruciton() == CALL)) ? OP2_ADDRESSING_FLAGS_OFFSET : OP1_ADDRESSING_FLAGS_OFFSET);
 
-                addrCode = op2Addr;
-                firstHalf |= addrCode << OP2_ADDRESSING_FLAGS_OFFSET;
+        char op1Flags = this->getOperandCode(op1, current, instr, locationCounter, secondHalf, lineNumber, line);
 
-                char op2Flags = this->getOperandCode(op2, current, instr, locationCounter, secondHalf, it->first);
-                firstHalf |= op2Flags;
-            }
+        if ((instr->getInstruciton() == PUSH) || (instr->getInstruciton() == CALL)) {
+            firstHalf |= op1Flags;
+        }
+        else {
+            firstHalf |= op1Flags << 5;
         }
 
-        int byte = (firstHalf >> 8 & 0xFF);
-        if (!(byte & 0xF0)) relStream << '0';
-        relStream << std::hex << byte << " ";
-        this->textBin.push_back((char)byte);
+        Operand* op2 = instr->getOperand2();
+        
+        if (op2 != nullptr) {
+            auto op2Addr = op2->getAddressing();
 
-        byte = firstHalf & 0xFF;
-        if (!(byte & 0xF0)) relStream << '0';
-        relStream << std::hex << byte << " ";
-        this->textBin.push_back((char)byte);
+            addrCode = op2Addr;
+            firstHalf |= addrCode << OP2_ADDRESSING_FLAGS_OFFSET;
 
-        if (instr->getInstructionSize() == 4) {
-            byte = (secondHalf >> 8) & 0xFF;
-            if (!(byte & 0xF0)) relStream << '0';
-            relStream << std::hex << byte << " ";
-            this->textBin.push_back((char)byte);
-            
-            byte = secondHalf & 0xFF;
-            if (!(byte & 0xF0)) relStream << '0';
-            relStream << std::hex << byte << " ";
-            this->textBin.push_back((char)byte);
+            char op2Flags = this->getOperandCode(op2, current, instr, locationCounter, secondHalf, lineNumber, line);
+            firstHalf |= op2Flags;
         }
-
     }
 
-    this->textOut = relStream.str();
+    this->textBin.push_back((char)((firstHalf >> 8) & 0xFF));
+    this->textBin.push_back((char)(firstHalf & 0xFF));
+
+    if (instr->getInstructionSize() == 4) {
+        this->textBin.push_back((char)((secondHalf >> 8) & 0xFF));
+        this->textBin.push_back((char)(secondHalf & 0xFF));
+    }
 }
 
 void Assembler::assembleDataSection(Section* current, size_t& locationCounter) {
-    std::stringstream relStream;
+    std::vector<SourceNode<Directive>>& section = current->getSectionCode() == SectionType::RO_DATA ? this->roData : this->data;
 
-    std::map<int, Directive*> *section;
+    for (auto& d: section) {
+        this->encodeDirective(d.node, current, locationCounter, d.lineNumber, d.line);
+    }
+}
+
+void Assembler::encodeDirective(Directive* d, Section* current, size_t& locationCounter, const int lineNumber, StringView line) {
     std::vector<char> *binData;
     if (current->getSectionCode() == SectionType::RO_DATA) {
-        relStream << "#rodata\n";
-        section = &this->roData;
         binData = &this->roDataBin;
     }
     else if (current->getSectionCode() == SectionType::DATA) {
-        relStream << "#data\n";
-        section = &this->data;
         binData = &this->dataBin;
     }
     else {
         throw AssemblingException("Unsupported section in method assembleDataSection");
     }
-    
-    
-    for (auto it = section->begin(); it != section->end(); ++it) {
-        Directive* d = it->second;
-
-        if (d->getType() == DirectiveType::SKIP) {
-            if (current->getSectionCode() == SectionType::RO_DATA) {
-                throw AssemblingException("Directive skip is not supported in rodata seciton", this->lines[it->first], it->first);
-            }
-
-            SkipDirective* sd = (SkipDirective*)d;
 
-            unsigned int size = sd->getOffset();
-            char t = 0;
-            for (int i = 0; i < size; ++i) {
-                relStream << "00 ";
-                binData->push_back(t);
-            }
-            locationCounter += size;
-        }
-        else if(d->getType() == DirectiveType::ALIGN) {
-            int size = ((AlignDirective*)d)->getSize();
-            short byte = 0;
-            for (int i = 0; i < size; i++) {
-                relStream << "00 "; 
-                
-                if (current->getSectionCode() == DATA)
-                    this->dataBin.push_back((char)byte);
-                else if (current->getSectionCode() == RO_DATA) 
-                    this->roDataBin.push_back((char)byte);
-            }
-            locationCounter = size;
-            continue;
+    if (d->getType() == DirectiveType::SKIP) {
+        if (current->getSectionCode() == SectionType::RO_DATA) {
+            throw AssemblingException("Directive skip is not supported in rodata seciton", line.str(), lineNumber);
         }
-        else {
-            BWLDirective* bwl = (BWLDirective*)d;
-            auto operands = bwl->getOperands();
-
-            if (operands.size() == 0) {
-                throw AssemblingException("Data in " + current->getName() +" section must be initialized", this->lines[it->first], it->first);
-            }
-            for(auto op: operands) {
-                if (std::regex_match(op, Utils::decimalRegex)) {
-                    bool valid = true;
-                    try {
-                        int val = std::stoi(op);
-
-                        locationCounter += bwl->getType() == DirectiveType::BYTE ? 1 : bwl->getType() == DirectiveType::WORD ? 2 : 4;
-                        if (bwl->getType() == DirectiveType::BYTE) {
-                            //if (val & MAX_BYTE_MASK) valid = false; 
-                            {
-                                relStream << std::setfill('0') << std::setw(2) << std::hex << (val & 0xFF) << ' ';
-                                binData->push_back((char)val);
-                            }
-                        }
-
-                        else if (bwl->getType() == DirectiveType::WORD) {
-                            //if (val & LIMIT_MASK) valid = false;
-                            {
-                                relStream << std::setfill('0') << std::setw(2) << std::hex << (val & 0xFF) << ' ';
-                                binData->push_back((char)(val & 0xFF));
-                                
-                                relStream << std::setfill('0') << std::setw(2) << std::hex << ((val >> 8) & 0xFF) << ' ';
-                                binData->push_back((char)((val >> 8) & 0xFF));
-                            }
-                        }
-
-                        else if (bwl->getType() == DirectiveType::LONG) {
-                            relStream << std::setfill('0') << std::setw(2) << std::hex << (val & 0xFF) << ' ';
-                            binData->push_back((char)(val & 0xFF));
-                            
-                            relStream << std::setfill('0') << std::setw(2) << std::hex << ((val >> 8) & 0xFF) << ' ';
-                            binData->push_back((char)((val >> 8) & 0xFF));
-
-                            relStream << std::setfill('0') << std::setw(2) << std::hex << ((val >> 16) & 0xFF) << ' ';
-                            binData->push_back((char)((val >> 16) & 0xFF));
-                            
-                            relStream << std::setfill('0') << std::setw(2) << std::hex << ((val >> 24) & 0xFF) << ' ';
-                            binData->push_back((char)((val >> 24) & 0xFF));
-                        }
-                    }
-                    catch(std::invalid_argument e) {
-                        valid = false;
-                    }
-                    //valid = true; //Odlucio si u jednom trenutku da zbog negativnih brojeva radis samo odsecanje ucitanog broja
-                    if (!valid) {
-                        throw AssemblingException("Argument out of range", this->lines[it->first], it->first);
-                    }
-                }
-                else if (std::regex_match(op, Utils::labelRegex)) {
-                    if (bwl->getType() == DirectiveType::BYTE) {
-                        throw AssemblingException("Cannot initialize byte with possible word", this->lines[it->first], it->first);
-                    }
-                    locationCounter += bwl->getType() == DirectiveType::WORD ? 2 : 4;
-                    short offset = this->resolveDataLabel(locationCounter, current, op, bwl, it->first);
 
-                    if (bwl->getType() == DirectiveType::WORD) {
+        SkipDirective* sd = (SkipDirective*)d;
 
-                        relStream << std::setfill('0') << std::setw(2) << std::hex << (offset & 0xFF) << ' ';
-                        binData->push_back((char)(offset & 0xFF));
+        unsigned int size = sd->getOffset();
+        binData->insert(binData->end(), size, 0);
+        locationCounter += size;
+    }
+    else if(d->getType() == DirectiveType::ALIGN) {
+        int size = ((AlignDirective*)d)->getSize();
+        binData->insert(binData->end(), size, 0);
+        locationCounter += size;
+    }
+    else {
+        BWLDirective* bwl = (BWLDirective*)d;
+        DirectiveType type = bwl->getType();
+        auto& operands = bwl->getOperands();
 
-                        relStream << std::setfill('0') << std::setw(2) << std::hex << (offset >> 8) << ' ';
-                        binData->push_back((char)((offset >> 8) & 0xFF));
+        if (operands.size() == 0) {
+            throw AssemblingException("Data in " + current->getName() +" section must be initialized", line.str(), lineNumber);
+        }
+        for(auto& op: operands) {
+            if (Lexer::isDecimal(op)) {
+                bool valid = true;
+                try {
+                    int val = std::stoi(op);
+
+                    locationCounter += type == DirectiveType::BYTE ? 1 : type == DirectiveType::WORD ? 2 : 4;
+                    if (type == DirectiveType::BYTE) {
+                        binData->push_back((char)val);
                     }
 
-                    else if (bwl->getType() == DirectiveType::LONG) {
-                        relStream << std::setfill('0') << std::setw(2) << std::hex << (offset & 0xFF) << ' ';
-                        binData->push_back((char)(offset & 0xFF));
-                        
-                        relStream << std::setfill('0') << std::setw(2) << std::hex << ((offset >> 8) & 0xFF) << ' ';
-                        binData->push_back((char)((offset >> 8) & 0xFF));
-
-                        relStream << "00 ";
-                        relStream << "00 ";
-                        binData->push_back(0);
-                        binData->push_back(0);
+                    else if (type == DirectiveType::WORD) {
+                        binData->push_back((char)(val & 0xFF));
+                        binData->push_back((char)((val >> 8) & 0xFF));
+                    }
 
+                    else if (type == DirectiveType::LONG) {
+                        binData->push_back((char)(val & 0xFF));
+                        binData->push_back((char)((val >> 8) & 0xFF));
+                        binData->push_back((char)((val >> 16) & 0xFF));
+                        binData->push_back((char)((val >> 24) & 0xFF));
                     }
                 }
-                else {
-                    throw AssemblingException("Unknown operand", this->lines[it->first], it->first);
+                catch(std::invalid_argument e) {
+                    valid = false;
+                }
+                //valid = true; //Odlucio si u jednom trenutku da zbog negativnih brojeva radis samo odsecanje ucitanog broja
+                if (!valid) {
+                    throw AssemblingException("Argument out of range", line.str(), lineNumber);
                 }
             }
+            else if (Lexer::isLabel(op)) {
+                if (type == DirectiveType::BYTE) {
+                    throw AssemblingException("Cannot initialize byte with possible word", line.str(), lineNumber);
+                }
+                locationCounter += type == DirectiveType::WORD ? 2 : 4;
+                short offset = this->resolveDataLabel(locationCounter, current, op, type, lineNumber, line);
+
+                binData->push_back((char)(offset & 0xFF));
+                binData->push_back((char)((offset >> 8) & 0xFF));
+
+                if (type == DirectiveType::LONG) {
+                    binData->push_back(0);
+                    binData->push_back(0);
+                }
+            }
+            else {
+                throw AssemblingException("Unknown operand", line.str(), lineNumber);
+            }
         }
     }
-    if (current->getSectionCode() == SectionType::RO_DATA) {
-        this->roDataOut = relStream.str();
-    }
-    else {
-        this->dataOut = relStream.str();
-    }
 }
 
-char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr,  const size_t& locationCounter, short& secondHalf, const int lineNumber) {
+char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr,  const size_t& locationCounter, short& secondHalf, const int lineNumber, StringView line) {
 
     AddressingCode op1Addr = op->getAddressing();
     const std::string op1Raw = op->getRawText();
@@ -329,8 +251,7 @@ char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr
 
                 short val = 0;
                 if (!(this->getImmediateValue(op1Raw, val))) {
-                    std::string line = this->lines[lineNumber];
-                    throw AssemblingException("Argument out of bounds", line, lineNumber);
+                    throw AssemblingException("Argument out of bounds", line.str(), lineNumber);
                 }
 
                 secondHalf = SWAP_BYTES((short)val);
@@ -338,26 +259,26 @@ char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr
             else if (op->getType() == OperandType::LABEL_VAL) {
                 std::string label = op1Raw.substr(1);
 
-                short offset = this->resolveLabel(locationCounter, current, label, lineNumber);
+                short offset = this->resolveLabel(locationCounter, current, label, lineNumber, line);
 
                 secondHalf = SWAP_BYTES(offset);
             }
             else if (op->getType() == OperandType::PCREL_VAL) {
                 std::string label = op1Raw.substr(1);
 
-                short offset = this->resolveLabel(locationCounter, current, label, lineNumber, true);
+                short offset = this->resolveLabel(locationCounter, current, label, lineNumber, line, true);
 
                 secondHalf = SWAP_BYTES(offset);
             }
             else {
-                throw AssemblingException("Method assembleTextSection, unsupported operand type with immediate addressing", this->lines[lineNumber], lineNumber);
+                throw AssemblingException("Method assembleTextSection, unsupported operand type with immediate addressing", line.str(), lineNumber);
             }
             break;
         }
 
         case AddressingCode::MEMDIR: {
             if (op->getType() == OperandType::MEMDIR_VAL) {
-                short offset = this->resolveLabel(locationCounter, current, op1Raw, lineNumber) ;
+                short offset = this->resolveLabel(locationCounter, current, op1Raw, lineNumber, line);
 
                 secondHalf = SWAP_BYTES(offset);
             }
@@ -367,14 +288,13 @@ char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr
 
                 if (!this->getImmediateValue(op1Raw.substr(1), val))
                 {
-                    std::string line = this->lines[lineNumber];
-                    throw AssemblingException("Argument out of bounds", line, lineNumber);
+                    throw AssemblingException("Argument out of bounds", line.str(), lineNumber);
                 }
 
                 secondHalf = SWAP_BYTES((short)val);
             }
             else {
-                throw AssemblingException("Method assembleTextSection, unsupported operand type with memory direct addressing", this->lines[lineNumber], lineNumber);
+                throw AssemblingException("Method assembleTextSection, unsupported operand type with memory direct addressing", line.str(), lineNumber);
             }
             break;
         }
@@ -389,7 +309,7 @@ char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr
                  regNum = 7;
                 off = op1Raw.substr(1);
                 
-                short offset = this->resolveLabel(locationCounter, current, op1Raw, lineNumber, true);
+                short offset = this->resolveLabel(locationCounter, current, op1Raw, lineNumber, line, true);
                 secondHalf = SWAP_BYTES(offset);
             }
 
@@ -402,8 +322,7 @@ char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr
                     short val = 0;
 
                     if (!this->getImmediateValue(off, val)) {
-                        std::string line = this->lines[lineNumber];
-                        throw AssemblingException("Argument out of bounds", line, lineNumber);
+                            throw AssemblingException("Argument out of bounds", line.str(), lineNumber);
                     }
 
                     secondHalf = SWAP_BYTES((short)val);
@@ -411,7 +330,7 @@ char Assembler::getOperandCode(Operand* op, Section* current, Instruction* instr
 
                 if (op->getType() == OperandType::REGIND_LAB_VAL) {
 
-                    short offset = this->resolveLabel(locationCounter, current, off, lineNumber);
+                    short offset = this->resolveLabel(locationCounter, current, off, lineNumber, line);
 
                     secondHalf = SWAP_BYTES(offset);
                 }
@@ -443,20 +362,24 @@ bool Assembler::getImmediateValue(const std::string strVal, short& immed) {
     return true;
 }
 
-short Assembler::resolveLabel(const size_t& locationCounter, Section* current, const std::string lab, const int lineNumber, const bool pcRel) {
-    
+short Assembler::resolveLabel(const size_t& locationCounter, Section* current, const std::string lab, const int lineNumber, StringView line, const bool pcRel) {
+    //Second half of the instruction is written after the first two bytes.
+    if (this->deferLabels) {
+        Fixup fixup = {current, this->textBin.size() + 2, locationCounter, lab, lineNumber, line, pcRel, DirectiveType::WORD};
+        this->fixups.push_back(fixup);
+        return 0;
+    }
+
     std::string label(lab);
  
     if (lab[0] == '&' || lab[0] == '$') {
         label = label.substr(1);
     }
-    if (this->symbolTable.find(label) == this->symbolTable.end()) {
-        std::string line = this->lines[lineNumber];
-        throw AssemblingException("Undefined label", line, lineNumber);
+    Symbol* s = this->symbolTable.find(label);
+    if (s == nullptr) {
+        throw AssemblingException("Undefined label", line.str(), lineNumber);
     }
 
-    Symbol* s = this->symbolTable[label];
-
     short offset = 0;
 
 
@@ -478,17 +401,8 @@ short Assembler::resolveLabel(const size_t& locationCounter, Section* current, c
             offset = (pcRel ? -2 : 0);
         }
 
-        std::stringstream relStream;
-            
-        relStream << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << std::hex << relOffset 
-                  << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << (pcRel ? "R_386_PC16" : "R_386_16")
-                  << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << s->getNo();
-        std::string relocationRecord(relStream.str());
-
         Relocation rel(relOffset, (pcRel ? RelocationType::R_386_PC16 : RelocationType::R_386_16), s->getNo());
         this->relText.push_back(rel);
-
-        this->txtRelText.push_back(relocationRecord);
     }
     
 
@@ -496,23 +410,30 @@ short Assembler::resolveLabel(const size_t& locationCounter, Section* current, c
     return offset;
 }
 
-short Assembler::resolveDataLabel(const size_t& locationCounter, Section* current, const std::string lab, BWLDirective* bwl, const int lineNumber) {
+short Assembler::resolveDataLabel(const size_t& locationCounter, Section* current, const std::string lab, DirectiveType type, const int lineNumber, StringView line) {
+    if (this->deferLabels) {
+        size_t position = current->getSectionCode() == SectionType::RO_DATA ? this->roDataBin.size() : this->dataBin.size();
+        Fixup fixup = {current, position, locationCounter, lab, lineNumber, line, false, type};
+        this->fixups.push_back(fixup);
+        return 0;
+    }
+
     std::string label(lab);
  
     if (lab[0] == '&' || lab[0] == '$') {
-        throw AssemblingException("& and $ are not allowed in " + current->getName() + " section.", this->lines[lineNumber], lineNumber);
+        throw AssemblingException("& and $ are not allowed in " + current->getName() + " section.", line.str(), lineNumber);
     }
     
-    Symbol* s = this->symbolTable[label];
+    Symbol* s = this->symbolTable.find(label);
 
     if (s == nullptr) {
-        throw AssemblingException("Unknown symbol", this->lines[lineNumber], lineNumber);
+        throw AssemblingException("Unknown symbol", line.str(), lineNumber);
     }
     short offset = 0;
-    size_t relOffset = locationCounter - current->getOffset() - (bwl->getType() == DirectiveType::WORD ? 2 : 4);
+    size_t relOffset = locationCounter - current->getOffset() - (type == DirectiveType::WORD ? 2 : 4);
     
     /*if (s->getSectionCode() == current->getSectionCode()) {
-        offset = s->getOffset() - locationCounter - (bwl->getType() == DirectiveType::WORD ? 2 : bwl->getType() == DirectiveType::BYTE ? 1 : 4);
+        offset = s->getOffset() - locationCounter - (type == DirectiveType::WORD ? 2 : type == DirectiveType::BYTE ? 1 : 4);
     }*/
     
     if (s->isLocal()) {        
@@ -527,38 +448,49 @@ short Assembler::resolveDataLabel(const size_t& locationCounter, Section* curren
     }
     
 
-    std::string relTypeStr;
     RelocationType relType;
 
-    if (bwl->getType() == DirectiveType::WORD || bwl->getType() == DirectiveType::LONG) {
-        relTypeStr = "R_386_16";
+    if (type == DirectiveType::WORD || type == DirectiveType::LONG) {
         relType = RelocationType::R_386_16;
     }
     else {
-        throw AssemblingException("Cannot rellocate this directive type", this->lines[lineNumber], lineNumber);
+        throw AssemblingException("Cannot rellocate this directive type", line.str(), lineNumber);
     }
 
-    std::stringstream relStream;
-
-    relStream << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << std::hex << relOffset 
-              << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << relTypeStr
-              << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << s->getNo();
-
     Relocation rel(relOffset, relType, s->getNo());
 
-    std::string relocationRecord(relStream.str());
-
     if (current->getSectionCode() == SectionType::DATA) {
-        this->txtRelData.push_back(relocationRecord);
         this->relData.push_back(rel);
     }
     else if (current->getSectionCode() == SectionType::RO_DATA) { 
-        this->txtRelROData.push_back(relocationRecord);
         this->relROData.push_back(rel);
     }
     else {
-        throw AssemblingException("Unsupported section in method resolveDataLabel", this->lines[lineNumber], lineNumber);
+        throw AssemblingException("Unsupported section in method resolveDataLabel", line.str(), lineNumber);
     }
 
     return offset;
-}
\ No newline at end of file
+}
+
+void Assembler::resolveFixups() {
+    this->deferLabels = false;
+
+    for (auto& fixup: this->fixups) {
+        std::vector<char>* bin;
+        short offset;
+
+        if (fixup.section->getSectionCode() == SectionType::TEXT) {
+            bin = &this->textBin;
+            offset = this->resolveLabel(fixup.locationCounter, fixup.section, fixup.label, fixup.lineNumber, fixup.line, fixup.pcRel);
+        }
+        else {
+            bin = fixup.section->getSectionCode() == SectionType::RO_DATA ? &this->roDataBin : &this->dataBin;
+            offset = this->resolveDataLabel(fixup.locationCounter, fixup.section, fixup.label, fixup.type, fixup.lineNumber, fixup.line);
+        }
+
+        (*bin)[fixup.position] = (char)(offset & 0xFF);
+        (*bin)[fixup.position + 1] = (char)((offset >> 8) & 0xFF);
+    }
+
+    this->fixups.clear();
+}
@@ -1,3 +0,0 @@
-#include "symbol.h"
-
-unsigned int ss::Symbol::noCounter = 0;
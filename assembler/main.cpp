@@ -1,56 +1,307 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
-#include <regex>
+#include <vector>
+#include <set>
+#include <memory>
+#include <iomanip>
 #include "string_tokenizer.h"
 #include "utils.h"
 #include "assembler.h"
+#include "thread_pool.h"
+#include "object_cache.h"
+#include "asm_declarations.h"
 
 using namespace ss;
 
-const std::string usage = "assembler <input> [<output>]";
+const std::string usage = "assembler [--one-pass | --optimize] [--listing] [<cache options>] <input> <output> [<start>]\n"
+                          "assembler --batch [--threads <n>] [--one-pass | --optimize] [--listing] [<cache options>] <input.s | @response file>...\n"
+                          "cache options: --cache <directory> [--cache-size <bytes>] [--cache-stats]";
 
+//File to assemble, response file lines are written as <input> <output> [<start>].
+struct Job {
+    std::string input;
+    std::string output;
+    int start;
+};
 
-int main(int argc, const char* argv[]) {
-    if (argc < 3) {
+//Options shared by every assembled file.
+struct Options {
+    bool onePass;
+    bool optimize;
+    bool listing;
+};
+
+//Assembles one file with its own assembler, so jobs can run at the same time.
+//Returns false and sets message if assembling failed.
+bool assembleFile(const Job& job, const Options& options, ObjectCache* cache, std::string& message) {
+    std::string input(job.input);
+    std::string output(job.output);
+    Assembler* as = nullptr;
+
+    try {
+        as = Assembler::getInstance(input, output, job.start);
+        as->setOnePass(options.onePass);
+        as->setOptimize(options.optimize);
+        as->setListing(options.listing);
+        as->setCache(cache);
+
+        as->assemble();
+
+        delete as;
+        return true;
+    }
+    catch (FileException& e) {
+        message = e.what();
+    }
+    catch (AssemblingException& e) {
+        message = e.what();
+    }
+    catch (StringTokenizerException& e) {
+        message = "Line ends before all of its tokens are read.";
+    }
+    catch (std::exception& e) {
+        message = e.what();
+    }
+
+    delete as;
+    return false;
+}
+
+bool readResponseFile(const std::string& name, std::vector<Job>& jobs) {
+    std::ifstream in(name);
+    if (!in.is_open()) {
+        std::cout << "ERROR: cannot open response file " << name << ".\n";
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+
+        std::istringstream words(line);
+        std::vector<std::string> args;
+        std::string word;
+        while (words >> word) args.push_back(word);
+
+        if (args.empty()) continue;
+
+        if ((args.size() < 2) || (args.size() > 3)) {
+            std::cout << "ERROR: invalid job at line " << lineNumber << " of " << name << ".\n";
+            return false;
+        }
+
+        Job job = {args[0], args[1], 0};
+        if (args.size() == 3) {
+            try {
+                job.start = std::stoi(args[2]);
+            }
+            catch (std::exception& e) {
+                std::cout << "ERROR: invalid start address at line " << lineNumber << " of " << name << ".\n";
+                return false;
+            }
+        }
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+//Prints cache use of this run, size is what is left after eviction.
+void printStats(ObjectCache& cache) {
+    CacheStats s = cache.getStats();
+    std::cout << std::left
+              << std::setw(FIELD_LENGTH) << "cache hits" << s.hits << "\n"
+              << std::setw(FIELD_LENGTH) << "cache misses" << s.misses << "\n"
+              << std::setw(FIELD_LENGTH) << "stored" << s.stored << "\n"
+              << std::setw(FIELD_LENGTH) << "evicted" << s.evicted << "\n"
+              << std::setw(FIELD_LENGTH) << "cache size" << s.size << " B\n";
+}
+
+//Files are assembled on a thread pool, errors are printed in the order the files were given,
+//so the output and exit status do not depend on scheduling.
+int assembleBatch(const std::vector<std::string>& args, unsigned int threads, const Options& options, ObjectCache* cache) {
+    std::vector<Job> jobs;
+
+    for (const std::string& arg : args) {
+        if (arg[0] == '@') {
+            if (!readResponseFile(arg.substr(1), jobs)) {
+                return -1;
+            }
+        }
+        //Object of x.s is x.o, listing is x.
+        else if ((arg.size() > 2) && (arg.compare(arg.size() - 2, 2, ".s") == 0)) {
+            Job job = {arg, arg.substr(0, arg.size() - 2), 0};
+            jobs.push_back(job);
+        }
+        else {
+            std::cout << "ERROR: cannot derive output of " << arg << ", list it in a response file.\n" << usage << std::endl;
+            return -1;
+        }
+    }
+
+    if (jobs.empty()) {
         std::cout << "ERROR: insufficient number of parameters.\n" << usage << std::endl;
         return -1;
     }
 
-    if (argc > 4) {
-        std::cout << "ERROR: too many parameters.\n" << usage << std::endl;
-        return -1;
+    //Two jobs writing the same object would race.
+    std::set<std::string> outputs;
+    for (const Job& job : jobs) {
+        if (!outputs.insert(job.output).second) {
+            std::cout << "ERROR: output " << job.output << " is given more than once.\n";
+            return -1;
+        }
     }
 
-    std::string input(argv[1]);
-    std::string output(argv[2]);
+    std::vector<std::string> messages(jobs.size());
+    std::vector<char> failed(jobs.size(), 0);
 
-    int start;
-    if (argc == 3) start = 0;
-    else start = std::stoi(argv[3]);
-    
-    //Creating assembler.
-    try {
-        Assembler* as = Assembler::getInstance(input, output, start);
+    ThreadPool pool(threads);
+    pool.parallelFor(jobs.size(), [&](size_t i) {
+        failed[i] = !assembleFile(jobs[i], options, cache, messages[i]);
+    });
 
-        as->assemble();
+    size_t nFailed = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (failed[i]) {
+            ++nFailed;
+            std::cout << jobs[i].input << ":" << messages[i] << "\n";
+        }
+    }
 
-        delete as;
+    std::cout << "Assembled " << (jobs.size() - nFailed) << " of " << jobs.size() << " files.\n";
+
+    return nFailed > 0 ? 1 : 0;
+}
+
+int main(int argc, const char* argv[]) {
+    Options options = {false, false, false};
+    bool batch = false;
+    unsigned int threads = 0;
+    std::string cacheDirectory;
+    unsigned long long cacheSize = OBJECT_CACHE_SIZE;
+    bool cacheStats = false;
+    std::vector<std::string> args;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg.compare("--one-pass") == 0) {
+            options.onePass = true;
+        }
+        else if (arg.compare("--optimize") == 0) {
+            options.optimize = true;
+        }
+        else if (arg.compare("--listing") == 0) {
+            options.listing = true;
+        }
+        else if (arg.compare("--batch") == 0) {
+            batch = true;
+        }
+        else if (arg.compare("--threads") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing number of threads.\n" << usage << std::endl;
+                return -1;
+            }
+            try {
+                threads = std::stoul(argv[++i]);
+            }
+            catch (std::exception& e) {
+                std::cout << "ERROR: invalid number of threads.\n" << usage << std::endl;
+                return -1;
+            }
+        }
+        else if (arg.compare("--cache") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing cache directory.\n" << usage << std::endl;
+                return -1;
+            }
+            cacheDirectory = argv[++i];
+        }
+        else if (arg.compare("--cache-size") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing cache size.\n" << usage << std::endl;
+                return -1;
+            }
+            try {
+                cacheSize = std::stoull(argv[++i]);
+            }
+            catch (std::exception& e) {
+                std::cout << "ERROR: invalid cache size.\n" << usage << std::endl;
+                return -1;
+            }
+        }
+        else if (arg.compare("--cache-stats") == 0) {
+            cacheStats = true;
+        }
+        else if (arg.compare(0, 2, "--") == 0) {
+            std::cout << "ERROR: unknown option " << arg << ".\n" << usage << std::endl;
+            return -1;
+        }
+        else {
+            args.push_back(arg);
+        }
     }
-    catch (FileException e) {
-        std::cout << e.what();
+
+    if (!batch && (args.size() < 2)) {
+        std::cout << "ERROR: insufficient number of parameters.\n" << usage << std::endl;
+        return -1;
     }
-    catch (AssemblingException& e) {
-        std::cout << e.what();
+
+    if (!batch && (args.size() > 3)) {
+        std::cout << "ERROR: too many parameters.\n" << usage << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<ObjectCache> cache;
+    if (!cacheDirectory.empty()) {
+        try {
+            cache.reset(new ObjectCache(cacheDirectory, cacheSize));
+        }
+        catch (FileException& e) {
+            std::cout << "ERROR: " << e.what() << usage << std::endl;
+            return -1;
+        }
     }
-    catch (StringTokenizerException e) {
-        
+
+    int status = 0;
+    if (batch) {
+        status = assembleBatch(args, threads, options, cache.get());
+        if (status < 0) {
+            return status;
+        }
     }
-    catch (std::exception e) {
-        std::cout<<e.what();
+    else {
+        Job job = {args[0], args[1], 0};
+        if (args.size() == 3) {
+            try {
+                job.start = std::stoi(args[2]);
+            }
+            catch (std::exception& e) {
+                std::cout << "ERROR: invalid start address.\n" << usage << std::endl;
+                return -1;
+            }
+        }
+
+        //Creating assembler.
+        std::string message;
+        if (!assembleFile(job, options, cache.get(), message)) {
+            std::cout << message;
+            status = 1;
+        }
+    }
+
+    if (cache) {
+        cache->evict();
+        if (cacheStats) {
+            printStats(*cache);
+        }
     }
     std::cout<<"\n==========END==========\n" << std::flush;
 
-    return 0;
+    return status;
 }
 
 
@@ -0,0 +1,245 @@
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <signal.h>
+#include <ctime>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <algorithm>
+
+#include "object_cache.h"
+#include "assembler.h"
+#include "mapped_file.h"
+#include "utils.h"
+#include "ss_exceptions.h"
+
+using namespace ss;
+
+#define KEY_LENGTH 16
+#define ENTRY_EXTENSION ".entry"
+#define TMP_EXTENSION ".tmp"
+#define ENTRY_MAGIC "SSOC"
+
+namespace {
+
+    //Entry file is this header, then source, object and listing.
+    struct EntryHeader {
+        char magic[4];
+        unsigned int version;
+        unsigned long long sourceSize;
+        unsigned long long objectSize;
+        unsigned long long listingSize;
+        short startAddress;
+        bool optimize;
+        bool hasListing;
+    };
+}
+
+ObjectCache::ObjectCache(const std::string& directory, unsigned long long maxSize) : directory(directory), maxSize(maxSize) {
+    if ((mkdir(directory.c_str(), 0755) != 0) && (errno != EEXIST)) {
+        throw FileException("Cannot create cache directory " + directory + ".\n");
+    }
+}
+
+unsigned long long ObjectCache::key(const CacheSource& source) {
+    unsigned int version = ASSEMBLER_VERSION;
+
+    unsigned long long hash = Utils::hash((const char*)&version, sizeof(version));
+    hash = Utils::hash((const char*)&source.startAddress, sizeof(source.startAddress), hash);
+    hash = Utils::hash((const char*)&source.optimize, sizeof(source.optimize), hash);
+    return Utils::hash(source.source.data(), source.source.size(), hash);
+}
+
+std::string ObjectCache::entry(unsigned long long key) const {
+    char name[KEY_LENGTH + 1];
+    std::snprintf(name, sizeof(name), "%016llx", key);
+    return this->directory + "/" + name;
+}
+
+bool ObjectCache::fetch(unsigned long long key, const CacheSource& source, std::vector<char>& object, const std::string& listingFile) {
+    std::string path = this->entry(key) + ENTRY_EXTENSION;
+
+    MappedFile cached(path);
+    EntryHeader header;
+    bool valid = cached.isOpen() && (cached.size() >= sizeof(EntryHeader));
+
+    if (valid) {
+        std::memcpy(&header, cached.data(), sizeof(EntryHeader));
+
+        //Key is only a hash, entry is used only if it was made from the same source.
+        valid = (std::memcmp(header.magic, ENTRY_MAGIC, sizeof(header.magic)) == 0)
+            && (header.version == ASSEMBLER_VERSION)
+            && (header.startAddress == source.startAddress)
+            && (header.optimize == source.optimize)
+            && (header.sourceSize == source.source.size())
+            && (sizeof(EntryHeader) + header.sourceSize + header.objectSize + header.listingSize == cached.size())
+            && (listingFile.empty() || header.hasListing)
+            && (std::memcmp(cached.data() + sizeof(EntryHeader), source.source.data(), source.source.size()) == 0);
+    }
+
+    if (!valid) {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        ++this->stats.misses;
+        return false;
+    }
+
+    const char* data = cached.data() + sizeof(EntryHeader) + header.sourceSize;
+    object.assign(data, data + header.objectSize);
+
+    if (!listingFile.empty()) {
+        std::ofstream out(listingFile, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+        if (!out.is_open()) {
+            throw AssemblingException("Cannot open file " + listingFile);
+        }
+        out.write(data + header.objectSize, header.listingSize);
+    }
+
+    //Modification time of the entry is its last use.
+    utime(path.c_str(), nullptr);
+
+    std::lock_guard<std::mutex> lock(this->mtx);
+    ++this->stats.hits;
+    return true;
+}
+
+bool ObjectCache::publish(const std::string& path, const char* data, size_t size) {
+    std::string tmp;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        tmp = path + TMP_EXTENSION + std::to_string(getpid()) + "." + std::to_string(this->tmpCounter++);
+    }
+
+    std::ofstream out(tmp, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(data, size);
+    out.close();
+
+    if (!out || (std::rename(tmp.c_str(), path.c_str()) != 0)) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void ObjectCache::store(unsigned long long key, const CacheSource& source, const std::vector<char>& object, const std::string& listingFile) {
+    MappedFile listing(listingFile.empty() ? Utils::empty : listingFile);
+    if (!listingFile.empty() && !listing.isOpen()) {
+        return;
+    }
+
+    EntryHeader header;
+    std::memset(&header, 0, sizeof(EntryHeader));
+    std::memcpy(header.magic, ENTRY_MAGIC, sizeof(header.magic));
+    header.version = ASSEMBLER_VERSION;
+    header.sourceSize = source.source.size();
+    header.objectSize = object.size();
+    header.listingSize = listingFile.empty() ? 0 : listing.size();
+    header.startAddress = source.startAddress;
+    header.optimize = source.optimize;
+    header.hasListing = !listingFile.empty();
+
+    std::vector<char> buffer;
+    buffer.reserve(sizeof(EntryHeader) + header.sourceSize + header.objectSize + header.listingSize);
+    buffer.insert(buffer.end(), (const char*)&header, (const char*)&header + sizeof(EntryHeader));
+    buffer.insert(buffer.end(), source.source.begin(), source.source.end());
+    buffer.insert(buffer.end(), object.begin(), object.end());
+    if (header.hasListing) {
+        buffer.insert(buffer.end(), listing.data(), listing.data() + listing.size());
+    }
+
+    if (!this->publish(this->entry(key) + ENTRY_EXTENSION, buffer.data(), buffer.size())) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mtx);
+    ++this->stats.stored;
+}
+
+void ObjectCache::evict() {
+    struct Entry {
+        unsigned long long size = 0;
+        //Last use in nanoseconds.
+        unsigned long long used = 0;
+    };
+
+    time_t now = std::time(nullptr);
+
+    DIR* dir = opendir(this->directory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+
+    //Ordered by key, so entries used at the same time are evicted in the same order.
+    std::map<std::string, Entry> entries;
+    unsigned long long total = 0;
+
+    while (struct dirent* file = readdir(dir)) {
+        std::string name(file->d_name);
+        std::string extension = name.size() > KEY_LENGTH ? name.substr(KEY_LENGTH) : Utils::empty;
+        bool tmp = extension.compare(0, sizeof(ENTRY_EXTENSION TMP_EXTENSION) - 1, ENTRY_EXTENSION TMP_EXTENSION) == 0;
+        if ((extension != ENTRY_EXTENSION) && !tmp) {
+            continue;
+        }
+
+        std::string path = this->directory + "/" + name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            continue;
+        }
+
+        //Temporary file is left behind when its writer died before renaming it. Process id can be
+        //reused, so old files are removed even if a process of that id is running.
+        if (tmp) {
+            pid_t pid = (pid_t)std::atol(extension.c_str() + sizeof(ENTRY_EXTENSION TMP_EXTENSION) - 1);
+            bool alive = (pid > 0) && ((kill(pid, 0) == 0) || (errno == EPERM));
+            if (!alive || (now - st.st_mtime > OBJECT_CACHE_TMP_AGE)) {
+                if (std::remove(path.c_str()) == 0) {
+                    continue;
+                }
+            }
+            total += st.st_size;
+            continue;
+        }
+
+        Entry& e = entries[name.substr(0, KEY_LENGTH)];
+        e.size = st.st_size;
+        e.used = (unsigned long long)st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+        total += st.st_size;
+    }
+    closedir(dir);
+
+    std::vector<std::pair<unsigned long long, std::string>> byUse;
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        byUse.push_back(std::make_pair(it->second.used, it->first));
+    }
+    std::stable_sort(byUse.begin(), byUse.end(), [](const std::pair<unsigned long long, std::string>& a, const std::pair<unsigned long long, std::string>& b) {
+        return a.first < b.first;
+    });
+
+    size_t evicted = 0;
+    for (size_t i = 0; (i < byUse.size()) && (total > this->maxSize); ++i) {
+        std::string path = this->directory + "/" + byUse[i].second + ENTRY_EXTENSION;
+        std::remove(path.c_str());
+
+        total -= entries[byUse[i].second].size;
+        ++evicted;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mtx);
+    this->stats.evicted += evicted;
+    this->stats.size = total;
+}
+
+CacheStats ObjectCache::getStats() {
+    std::lock_guard<std::mutex> lock(this->mtx);
+    return this->stats;
+}
@@ -2,9 +2,13 @@
 #include "asm_declarations.h"
 #include "ss_exceptions.h"
 #include "instruction.h"
+#include "executable_image.h"
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 #include <thread>
 #include <chrono>
+#include <cstdio>
 #include <termios.h>
 #include <unistd.h>
 using namespace ss;
@@ -12,7 +16,8 @@ using namespace ss;
 
 
 Emulator::Emulator(Executable* e) : callStack(0), running(false),
-    stackStart(STACK_START), stackSize(STACK_SIZE) {
+    stackStart(STACK_START), stackSize(STACK_SIZE), stopReason(NOT_STOPPED),
+    countdown(0), countdownStart(0), retired(0), outputBytes(0), outputLimitReached(false), output(&std::cout), interactive(true) {
     this->cpu.r[7] = e->startAddress;
     this->memory = e->content;
     this->instructionError = false;
@@ -22,16 +27,109 @@ Emulator::Emulator(Executable* e) : callStack(0), running(false),
     cpu.psw = 0;
     #endif
     exe = e;
+
+    //Code is normalized one section at a time, before limits are joined.
+    this->normalizeCode();
+
+    Emulator::mergeLimits(exe->ex);
+    Emulator::mergeLimits(exe->rw);
+    Emulator::mergeLimits(exe->rd);
+}
+
+void Emulator::mergeLimits(std::vector<Limit>& limits) {
+    if (limits.size() < 2) return;
+
+    std::sort(limits.begin(), limits.end());
+
+    size_t last = 0;
+    for (size_t i = 1; i < limits.size(); ++i) {
+        if ((unsigned int)limits[i].low <= (unsigned int)limits[last].high + 1) {
+            limits[last].high = std::max(limits[last].high, limits[i].high);
+        }
+        else {
+            limits[++last] = limits[i];
+        }
+    }
+    limits.resize(last + 1);
+}
+
+void Emulator::setProfiling(bool profiling) {
+    if (profiling) {
+        this->execCounts.assign((unsigned)MAX_SHORT + 1, 0);
+    }
+    else {
+        this->execCounts.clear();
+    }
+}
+
+void Emulator::writeProfile(std::ostream& os) const {
+    if (this->execCounts.empty()) return;
+
+    //Instructions up to the next symbol are counted to the symbol before them.
+    const std::vector<ExecutableSymbol>& symbols = exe->symbols;
+    for (int i = 0; i < symbols.size(); ++i) {
+        unsigned int end = (i + 1 < symbols.size()) ? symbols[i + 1].address : (unsigned)MAX_SHORT + 1;
+        unsigned long long count = 0;
+
+        for (unsigned int address = symbols[i].address; address < end; ++address) {
+            count += this->execCounts[address];
+        }
+
+        os << symbols[i].name << " " << count << "\n";
+    }
+    os << std::flush;
+}
+
+void Emulator::normalizeCode() {
+    //Assembler writes the first word of every instruction big endian and all other words
+    //little endian. Swapping first words once here lets fetch read every word the same way.
+    for (int i = 0; i < exe->ex.size(); ++i) {
+        unsigned int address = exe->ex[i].first;
+        unsigned int high = exe->ex[i].high;
+
+        while (address + 1 <= high) {
+            Address firstHalf = (((Address)this->memory[address] & 0xFF) << 8) | ((Address)this->memory[address + 1] & 0xFF);
+
+            this->memory[address] = firstHalf & 0xFF;
+            this->memory[address + 1] = (firstHalf >> 8) & 0xFF;
+
+            address += this->instructionSize(firstHalf);
+        }
+    }
+}
+
+Address Emulator::instructionSize(const Address firstHalf) const {
+    InstructionCode opCode = (InstructionCode)((firstHalf & OPCODE_MASK) >> OPCODE_SHIFT);
+
+    if (!this->opCodeValid(opCode) || (Instruction::operandNumber[opCode] == 0)) {
+        return 2;
+    }
+
+    AddressingCode addressing1 = (AddressingCode)((firstHalf & OP1_ADDR) >> OP1_ADDR_SHIFT);
+    bool short1 = (addressing1 == REGDIR) || ((addressing1 == IMMED) && (((firstHalf & OP1_REG) >> OP1_REG_SHIFT) == 0x7));
+
+    AddressingCode addressing2 = (AddressingCode)((firstHalf & OP2_ADDR) >> OP2_ADDR_SHIFT);
+    bool short2 = (addressing2 == REGDIR) || ((addressing2 == IMMED) && ((firstHalf & OP2_REG) == 0x7));
+
+    if (Instruction::operandNumber[opCode] == 1) {
+        //Push and call keep their only operand in src fields.
+        bool isShort = ((opCode == PUSH) || (opCode == CALL)) ? short2 : short1;
+        return isShort ? 2 : 4;
+    }
+
+    return (short1 && short2) ? 2 : 4;
 }
 
 void Emulator::startEmulation() {
     
 
     struct termios t;
-	tcgetattr(STDIN_FILENO, &t); //get the current terminal I/O structure
-    t.c_lflag &= ~ICANON; //Manipulate the flag bits to do what you want it to do
-    t.c_lflag &= ~ECHO;
-    tcsetattr(STDIN_FILENO, TCSANOW, &t); //Apply the new settings
+    if (this->interactive) {
+        tcgetattr(STDIN_FILENO, &t); //get the current terminal I/O structure
+        t.c_lflag &= ~ICANON; //Manipulate the flag bits to do what you want it to do
+        t.c_lflag &= ~ECHO;
+        tcsetattr(STDIN_FILENO, TCSANOW, &t); //Apply the new settings
+    }
 
 
     cpu.psw = cpu.psw | SET_I;
@@ -39,41 +137,47 @@ void Emulator::startEmulation() {
     this->running = true;
 
     std::thread timer(tick, this);
-    std::thread kb(keyboard, this);
+    //Keyboard is read only in interactive runs.
+    std::thread kb;
+    if (this->interactive) {
+        kb = std::thread(keyboard, this);
+    }
     try {
     //t.detach();
         this->run();
     }
     catch (std::exception& e) {
-        std::cout << e.what();
-        std::cout << std::endl << "Press any key to exit. ";
-        mtx.lock();
-        this->running = false;
-        mtx.unlock();
+        *this->output << e.what();
+        if (this->interactive) {
+            *this->output << std::endl << "Press any key to exit. ";
+        }
+        this->stop(EXCEPTION);
     }
 
     timer.join();
-    kb.join();
+    if (kb.joinable()) {
+        kb.join();
+    }
     
-    tcgetattr(STDIN_FILENO, &t); //get the current terminal I/O structure
-    t.c_lflag |= ICANON; //Manipulate the flag bits to do what you want it to do
-    t.c_lflag |= ECHO;
-    tcsetattr(STDIN_FILENO, TCSANOW, &t); //Apply the new settings
+    if (this->interactive) {
+        tcgetattr(STDIN_FILENO, &t); //get the current terminal I/O structure
+        t.c_lflag |= ICANON; //Manipulate the flag bits to do what you want it to do
+        t.c_lflag |= ECHO;
+        tcsetattr(STDIN_FILENO, TCSANOW, &t); //Apply the new settings
+    }
 }
 
 void Emulator::tick(Emulator* emulator) {
     while(1) {
-        std::this_thread::sleep_for(std::chrono::seconds(3000));
-
         if (!emulator) break;
-        emulator->mtx.lock();
-        if (!emulator->running) {
-             emulator->mtx.unlock();
-             break;
-        }
 
+        //Waiting for the next tick, or until emulation is stopped.
+        std::unique_lock<std::mutex> lock(emulator->mtx);
+        if (emulator->stopCv.wait_for(lock, std::chrono::seconds(3000), [emulator] { return !emulator->running; })) {
+            break;
+        }
 
-        emulator->mtx.unlock();
+        lock.unlock();
         emulator->registerInterrupt(TIMER);
 
     }
@@ -91,8 +195,12 @@ void Emulator::keyboard(Emulator* emulator) {
             break;
         }
         emulator->mtx.unlock();
-        char k;
+        int k;
 		k = std::getchar();
+
+        //Input is closed, there is nothing more to read.
+        if (k == EOF) break;
+
         emulator->writeMtx.lock();
         if (emulator->running) {
             emulator->memory[KEYBOARD_REG] = k;
@@ -114,25 +222,119 @@ void Emulator::registerInterrupt(InterruptType type) {
     mtx.unlock();
 }
 void Emulator::run() {
+    this->startTime = std::chrono::steady_clock::now();
+    this->countdownStart = this->countdown = this->nextWatchdogInterval();
+
+    bool profiling = !this->execCounts.empty();
+
     while (running) {
 
+        if (profiling) {
+            ++this->execCounts[cpu.r[PC]];
+        }
+
         this->fetchInstruction();
         this->getOperands();
         this->executeInstruction();
 
         this->interrupt();
         this->instructionError = false;
+
+        //Limits are checked only when countdown expires, so the loop stays cheap.
+        if (--this->countdown == 0) {
+            this->watchdog();
+        }
+    }
+
+    if (this->stopReason != HALTED && this->stopReason != EXCEPTION) {
+        this->dumpState(*this->output);
+    }
+    if (this->interactive) {
+        *this->output << "\nRun ended, press any key to exit. " << std::flush;
     }
-    std::cout << "\nRun ended, press any key to exit. " << std::flush;
 }
 
-void Emulator::fetchInstruction() {
-    //Reading first two bytes of instruction
-    //C++ by default reads data as little endian and swaps bytes, so we need to swap it back.
+unsigned long Emulator::nextWatchdogInterval() const {
+    unsigned long interval = WATCHDOG_INTERVAL;
+
+    //Instruction budget is exact, last interval is shortened to hit it.
+    if (this->limits.instructions != 0) {
+        unsigned long long remaining = this->limits.instructions > this->retired ? this->limits.instructions - this->retired : 1;
+        if (remaining < interval) {
+            interval = (unsigned long)remaining;
+        }
+    }
+
+    return interval;
+}
+
+void Emulator::watchdog() {
+    this->retired += this->countdownStart - this->countdown;
+    this->countdownStart = this->countdown;
+
+    if (this->outputLimitReached) {
+        this->stop(OUTPUT_LIMIT);
+        return;
+    }
+
+    if ((this->limits.instructions != 0) && (this->retired >= this->limits.instructions)) {
+        this->stop(INSTRUCTION_LIMIT);
+        return;
+    }
+
+    if ((this->limits.outputBytes != 0) && (this->outputBytes >= this->limits.outputBytes)) {
+        this->stop(OUTPUT_LIMIT);
+        return;
+    }
+
+    if (this->limits.milliseconds != 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->startTime);
+        if ((unsigned long long)elapsed.count() >= this->limits.milliseconds) {
+            this->stop(TIME_LIMIT);
+            return;
+        }
+    }
+
+    this->countdownStart = this->countdown = this->nextWatchdogInterval();
+}
+
+void Emulator::stop(StopReason reason) {
+    mtx.lock();
+    this->running = false;
+    if (this->stopReason == NOT_STOPPED) {
+        this->stopReason = reason;
+    }
+    mtx.unlock();
+
+    this->stopCv.notify_all();
+}
+
+unsigned long long Emulator::getRetiredInstructions() const {
+    return this->retired + (this->countdownStart - this->countdown);
+}
+
+void Emulator::dumpState(std::ostream& os) const {
+    const char* reason = this->stopReason == INSTRUCTION_LIMIT ? "instruction limit reached" :
+                         this->stopReason == TIME_LIMIT ? "time limit reached" :
+                         this->stopReason == OUTPUT_LIMIT ? "output limit reached" : "stopped";
 
+    os << "\nEmulation stopped: " << reason << ".\n"
+       << "Retired instructions: " << std::dec << this->getRetiredInstructions() << "\n"
+       << "Output bytes: " << this->outputBytes << "\n";
 
+    for (int i = 0; i < 8; ++i) {
+        os << "r" << i << " = 0x" << std::hex << std::setfill('0') << std::setw(4) << this->cpu.r[i] << (i % 4 == 3 ? "\n" : "  ");
+    }
+
+    os << "psw = 0x" << std::setw(4) << this->cpu.psw
+       << "  ir0 = 0x" << std::setw(4) << this->cpu.ir0
+       << "  ir1 = 0x" << std::setw(4) << this->cpu.ir1 << std::dec << std::setfill(' ') << std::endl;
+}
+
+void Emulator::fetchInstruction() {
+    //Reading first two bytes of instruction
+    //First words were converted to host order when the program was loaded.
     Address firstHalf = this->getMemoryValue(this->memory + cpu.r[PC], EX);
-    firstHalf = this->swapBytes(firstHalf);
 
     //Incrementing PC
     cpu.r[PC] += 2;
@@ -168,7 +370,7 @@ void Emulator::fetchInstruction() {
                 AddressingCode addressing = (AddressingCode)add;
 
                 if (!this->addressingValid(addressing)) {
-                    std::cout << "Invalid addressing code, opCode = " << opCode;
+                    *this->output << "Invalid addressing code, opCode = " << opCode;
                     this->instructionError = true;
                     return;
                     //throw EmulatingException("Invalid addressing code, opCode = " + opCode);
@@ -198,7 +400,7 @@ void Emulator::fetchInstruction() {
                 AddressingCode addressing = (AddressingCode)add;
 
                 if (!this->addressingValid(addressing)) {
-                    std::cout << "Invalid addressing code, addressingCode = " << addressing;
+                    *this->output << "Invalid addressing code, addressingCode = " << addressing;
                     this->instructionError = true;
                     return;
                     //throw EmulatingException("Invalid addressing code, addressingCode = " + addressing);
@@ -227,7 +429,7 @@ void Emulator::fetchInstruction() {
         AddressingCode addressing1 = (AddressingCode)add1;
 
         if (!this->addressingValid(addressing1)) {
-            std::cout << "Invalid addressing code, addressingCode = " << addressing1;
+            *this->output << "Invalid addressing code, addressingCode = " << addressing1;
             this->instructionError = true;
             return;
 
@@ -252,7 +454,7 @@ void Emulator::fetchInstruction() {
         AddressingCode addressing2 = (AddressingCode)add2;
 
         if (!this->addressingValid(addressing2)) {
-            std::cout << "Invalid addressing code, addressingCode = " << addressing2;
+            *this->output << "Invalid addressing code, addressingCode = " << addressing2;
             this->instructionError = true;
             return;
             //throw EmulatingException("Invalid addressing code, addressingCode = " + addressing2);
@@ -261,7 +463,7 @@ void Emulator::fetchInstruction() {
         if (!(addressing2 == REGDIR) && !isPsw2) {
         
             if (hasSecond) {
-                std::cout<< "Found combination of two memory addresing in one instruction.";
+                *this->output<< "Found combination of two memory addresing in one instruction.";
                 this->instructionError = true;
                 return;
                 //throw EmulatingException("Found combination of two memory addresing in one instruction.");
@@ -302,7 +504,7 @@ void Emulator::getOperands() {
                 AddressingCode addressing = (AddressingCode)add;
 
                 if (!this->addressingValid(addressing)) {
-                    std::cout << "Invalid addressing code.";
+                    *this->output << "Invalid addressing code.";
                     this->instructionError = true;
                     return;
                     //throw EmulatingException("Invalid addressing code, addressingCode = " + addressing);
@@ -317,7 +519,7 @@ void Emulator::getOperands() {
                 AddressingCode addressing = (AddressingCode)add;
 
                 if (!this->addressingValid(addressing)) {
-                    std::cout << "Invalid addressing code.";
+                    *this->output << "Invalid addressing code.";
                     this->instructionError = true;
                     return;
                     //throw EmulatingException("Invalid addressing code, addressingCode = " + addressing);
@@ -335,7 +537,7 @@ void Emulator::getOperands() {
         AddressingCode addressing1 = (AddressingCode)add1;
 
         if (!this->addressingValid(addressing1)) {
-            std::cout << "Invalid addressing code.";
+            *this->output << "Invalid addressing code.";
             this->instructionError = true;
             return;
             //throw EmulatingException("Invalid addressing code, addressingCode = " + addressing1);
@@ -348,7 +550,7 @@ void Emulator::getOperands() {
         AddressingCode addressing2 = (AddressingCode)add2;
 
         if (!this->addressingValid(addressing2)) {
-            std::cout << "Invalid addressing code.";
+            *this->output << "Invalid addressing code.";
             this->instructionError = true;
             return;
             //throw EmulatingException("Invalid addressing code, addressingCode = " + addressing2);
@@ -568,15 +770,6 @@ bool Emulator::checkCondition() const {
     }
 }
 
-Address Emulator::swapBytes(const Address bytes) const {
-    char firstHalf = (bytes >> 8) & 0xFF;
-    char secondHalf = bytes & 0xFF;
-
-    unsigned short newHigh = (unsigned short)secondHalf << 8;
-    unsigned short newLow = (unsigned short)firstHalf & 0xFF;
-    return newHigh | newLow;
-}
-
 Address Emulator::getMemoryValue(char* addr, Access type) {
     // int address = reinterpret_cast<int>(addr);
     // Address shortAddress = (Address)(address & 0xFFFF);
@@ -584,9 +777,18 @@ Address Emulator::getMemoryValue(char* addr, Access type) {
         throw EmulatingException("Segmentation fault.\n");
     }
     writeMtx.lock();
-    Address* mar = (Address*)addr;
+    Address value;
+    #ifdef ALIGNED_FAST_PATH
+    if (!((addr - this->memory) & 1)) {
+        value = *(Address*)addr;
+    }
+    else
+    #endif
+    {
+        value = ((Address)addr[0] & 0xFF) | (((Address)addr[1] & 0xFF) << 8);
+    }
     writeMtx.unlock();
-    return *mar;
+    return value;
 }
 
 void Emulator::setMemoryValue(char* addr, short& val) {
@@ -597,17 +799,36 @@ void Emulator::setMemoryValue(char* addr, short& val) {
     }
 
     this->writeMtx.lock();
-    Address* mar = (Address*)addr;
-    *mar = val;
+    #ifdef ALIGNED_FAST_PATH
+    if (!((addr - this->memory) & 1)) {
+        *(Address*)addr = val;
+    }
+    else
+    #endif
+    {
+        addr[0] = val & 0xFF;
+        addr[1] = (val >> 8) & 0xFF;
+    }
 
 
     int memAddr = (addr - this->memory);
     if (memAddr == OUTPUT_REG) {
+        //Output limit is exact, watchdog is triggered at the end of this instruction.
+        //Instructions of the interval so far are retired first, so cutting it short doesn't count the rest.
+        if ((this->limits.outputBytes != 0) && (this->outputBytes >= this->limits.outputBytes)) {
+            this->retired += this->countdownStart - this->countdown;
+            this->countdownStart = this->countdown = 1;
+            this->outputLimitReached = true;
+            this->writeMtx.unlock();
+            return;
+        }
+        ++this->outputBytes;
+
         if (val == 0x10) {
-            std::cout << ('\n') << std::flush;
+            *this->output << ('\n') << std::flush;
         }
         else {
-            std::cout << (char)val << std::flush;
+            *this->output << (char)val << std::flush;
         }
     }
     this->writeMtx.unlock();
@@ -688,9 +909,7 @@ void Emulator::storeOperand(InstructionCode opCode) {
 
                     bool halt = ((reg == 7) && ((cpu.dst == (short)MAX_SHORT)));
                     if (halt) {
-                        Emulator::mtx.lock();
-                        this->running = false;
-                        Emulator::mtx.unlock();
+                        this->stop(HALTED);
                     }
                         
                     cpu.r[reg] = cpu.dst;
@@ -906,16 +1125,11 @@ bool Emulator::access(Address address, Access type) {
 }
 
 Emulator::~Emulator() {
-    if (this->memory != nullptr) {
-        delete[] this->memory;
-        this->memory = nullptr;
-    }
-    if (this->exe != nullptr) {
+    //Memory is the executable content, it is released together with the executable.
+    this->memory = nullptr;
 
-        exe->ex.clear();
-        exe->rd.clear();
-        exe->rw.clear();
-        delete exe;
+    if (this->exe != nullptr) {
+        ExecutableImage::release(exe);
         exe = nullptr;
     }
 
@@ -1,32 +1,121 @@
 #include "linker.h"
 #include "ss_exceptions.h"
 #include "emulator.h"
+#include "executable_image.h"
 #include <iostream>
+#include <fstream>
 #include <thread>
 #include <chrono>
+#include <string>
+#include <vector>
 using namespace ss;
 
+const std::string usage = "emul [--max-instructions <n>] [--max-time <ms>] [--max-output <bytes>] [--profile <file>] <image> | [--fixed-addresses] [--ivt <object>] <input>...";
 
 int main(int argc,  const char* argv[]) {
 
+    RunLimits limits;
+    std::vector<std::string> files;
+    std::string profile;
+    std::string ivTable;
+    bool fixedPlacement = false;
 
-    const char** args = &argv[1];
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
 
+        if (arg.compare(0, 2, "--") != 0) {
+            files.push_back(arg);
+            continue;
+        }
+
+        if (arg.compare("--fixed-addresses") == 0) {
+            fixedPlacement = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cout << "ERROR: missing value for option " << arg << ".\n" << usage << std::endl;
+            return -1;
+        }
+
+        if (arg.compare("--profile") == 0) {
+            profile = argv[++i];
+            continue;
+        }
+
+        //IV table object is linked like other inputs.
+        if (arg.compare("--ivt") == 0) {
+            ivTable = argv[++i];
+            files.push_back(ivTable);
+            continue;
+        }
+
+        unsigned long long value = 0;
+        try {
+            value = std::stoull(argv[++i]);
+        }
+        catch (std::exception& e) {
+            std::cout << "ERROR: invalid value for option " << arg << ".\n" << usage << std::endl;
+            return -1;
+        }
+
+        if (arg.compare("--max-instructions") == 0) {
+            limits.instructions = value;
+        }
+        else if (arg.compare("--max-time") == 0) {
+            limits.milliseconds = value;
+        }
+        else if (arg.compare("--max-output") == 0) {
+            limits.outputBytes = value;
+        }
+        else {
+            std::cout << "ERROR: unknown option " << arg << ".\n" << usage << std::endl;
+            return -1;
+        }
+    }
+
+    int status = 0;
     try {
-        Linker linker;
-        auto exe = linker.linkFiles(args, argc - 1);
+        //Linked image is mapped directly, object files are linked first.
+        Executable* exe = nullptr;
+        if ((files.size() == 1) && ExecutableImage::isImage(files[0])) {
+            exe = ExecutableImage::load(files[0]);
+        }
+        else {
+            Linker linker;
+            linker.setFixedPlacement(fixedPlacement);
+            linker.setIvTable(ivTable);
+            exe = linker.linkFiles(files);
+        }
         Emulator emulator(exe);
+        emulator.setLimits(limits);
+        emulator.setProfiling(!profile.empty());
         emulator.startEmulation();
         exe = nullptr;
+
+        if (!profile.empty()) {
+            std::ofstream output(profile);
+            if (!output.is_open()) {
+                throw EmulatingException("Cannot open profile " + profile);
+            }
+            emulator.writeProfile(output);
+        }
+
+        //Runs stopped by a limit are reported through exit status.
+        StopReason reason = emulator.getStopReason();
+        if (reason == INSTRUCTION_LIMIT || reason == TIME_LIMIT || reason == OUTPUT_LIMIT) {
+            status = 2;
+        }
         std::cout << "\nEMULATOR CLOSED\n" << std::flush;
-        
+
     }
     // catch(LinkingException& e) {
     //     std::cout << e.what();
     // }
     catch(std::exception& e) {
         std::cout << e.what() << std::flush;
+        status = 1;
     }
     std::cout << std::flush;
-    return 0;
-}
\ No newline at end of file
+    return status;
+}
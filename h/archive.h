@@ -0,0 +1,88 @@
+#ifndef _SS_ARCHIVE_H_
+#define _SS_ARCHIVE_H_
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "mapped_file.h"
+#include "string_view.h"
+
+#define ARCHIVE_MAGIC "SSAR"
+#define ARCHIVE_VERSION 1
+//Members are aligned so their tables can be read in place.
+#define ARCHIVE_MEMBER_ALIGNMENT 8
+
+namespace ss {
+
+    //Archive layout: header, member table, symbol index, string table and member
+    //object files. Strings are stored as length followed by characters, like in
+    //object files, and are referenced by offset into the string table.
+    struct ArchiveHeader {
+        char magic[4];
+        unsigned int version;
+        unsigned int memberNum;
+        unsigned int symbolNum;
+        unsigned int strTabSize;
+    };
+
+    struct ArchiveMember {
+        unsigned int name;
+        unsigned int offset;
+        unsigned int size;
+    };
+
+    //Symbol defined by a member, first member wins if more of them define it.
+    struct ArchiveSymbol {
+        unsigned int name;
+        unsigned int member;
+    };
+
+    //Static library of object files, read from a mapped file.
+    class Archive {
+    public:
+        Archive(std::unique_ptr<MappedFile> mapping, const std::string& name);
+
+        Archive(const Archive&) = delete;
+        Archive& operator=(const Archive&) = delete;
+
+        static bool isArchive(const char* data, size_t size);
+
+        //Bundles object files and builds the symbol index from their symbol tables.
+        static void write(const std::vector<std::string>& objects, const std::string& output);
+
+        const std::string& getName() const { return name; }
+
+        size_t memberCount() const { return members.size(); }
+
+        StringView memberName(size_t member) const { return memberNames[member]; }
+
+        const char* memberData(size_t member) const { return mapping->data() + members[member].offset; }
+
+        size_t memberSize(size_t member) const { return members[member].size; }
+
+        size_t symbolCount() const { return symbols.size(); }
+
+        StringView symbolName(size_t symbol) const { return symbolNames[symbol]; }
+
+        unsigned int symbolMember(size_t symbol) const { return symbols[symbol].member; }
+
+        //Returns member defining symbol, or -1 if no member defines it.
+        int findSymbol(StringView symbol) const;
+
+    private:
+        StringView readString(unsigned int offset, const char* strTab, size_t strTabSize) const;
+
+        std::unique_ptr<MappedFile> mapping;
+        std::string name;
+
+        std::vector<ArchiveMember> members;
+        std::vector<StringView> memberNames;
+        std::vector<ArchiveSymbol> symbols;
+        std::vector<StringView> symbolNames;
+
+        std::unordered_map<StringView, unsigned int, StringViewHash> index;
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _SS_ARENA_H_
+#define _SS_ARENA_H_
+
+#include <cstddef>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+namespace ss {
+
+    //Bump allocator, objects created in it live until the arena is destroyed or rewound.
+    //Destructors are run in reverse order of creation, memory is released block by block.
+    class Arena {
+    public:
+        //Position in the arena, everything created after it can be released with rewind.
+        struct Mark {
+            size_t block;
+            size_t used;
+            size_t destructors;
+        };
+
+        Arena(size_t blockSize = ARENA_BLOCK_SIZE);
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        template<typename T, typename... Args>
+        T* create(Args&&... args) {
+            T* object = new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if (!std::is_trivially_destructible<T>::value) {
+                Destructor d = {object, &Arena::destroy<T>};
+                this->destructors.push_back(d);
+            }
+            return object;
+        }
+
+        void* allocate(size_t size, size_t align);
+
+        Mark mark() const;
+
+        void rewind(const Mark& mark);
+
+        //Bytes taken from blocks, including alignment padding.
+        size_t bytesUsed() const;
+
+        ~Arena();
+    private:
+        struct Destructor {
+            void* object;
+            void (*destroy)(void*);
+        };
+
+        template<typename T>
+        static void destroy(void* object) {
+            ((T*)object)->~T();
+        }
+
+        void runDestructors(size_t from);
+
+        std::vector<char*> blocks;
+        std::vector<size_t> sizes;
+        std::vector<Destructor> destructors;
+
+        //Index of the block objects are taken from and bytes taken from it.
+        size_t current = 0;
+        size_t used = 0;
+        size_t blockSize;
+    };
+}
+
+#endif
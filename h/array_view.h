@@ -0,0 +1,33 @@
+#ifndef _SS_ARRAY_VIEW_H_
+#define _SS_ARRAY_VIEW_H_
+
+#include <cstddef>
+
+namespace ss {
+
+    //Non owning view of an array, referenced memory must outlive the view.
+    template<typename T>
+    class ArrayView {
+    public:
+        ArrayView() : ptr(nullptr), count(0) {}
+        ArrayView(const T* ptr, size_t count) : ptr(ptr), count(count) {}
+
+        size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+        const T& operator[](size_t i) const { return ptr[i]; }
+
+        const T* data() const { return ptr; }
+
+        const T* begin() const { return ptr; }
+
+        const T* end() const { return ptr + count; }
+
+    private:
+        const T* ptr;
+        size_t count;
+    };
+}
+
+#endif
@@ -1,6 +1,5 @@
 #ifndef _SS_ASSEMBLER_H_
 #define _SS_ASSEMBLER_H_
-#include <regex>
 #include <string>
 #include <fstream>
 #include <exception>
@@ -10,18 +9,23 @@
 
 #include "ss_exceptions.h"
 #include "asm_declarations.h"
+#include "arena.h"
+#include "string_view.h"
+#include "symbol_table.h"
 
 #define CONDITION_FLAGS_OFFSET 14
 #define INSTRUCTION_FLAGS_OFFSET 10
 #define OP1_ADDRESSING_FLAGS_OFFSET 8
 #define OP2_ADDRESSING_FLAGS_OFFSET 3
 
+//Bumped whenever assembled output changes, cached objects of other versions are not used.
+#define ASSEMBLER_VERSION 2
+
 #define SWAP_BYTES(x) (((x << 8) & 0xFF00) | ((x >> 8) & 0xFF))
 
 namespace ss {
     
     class Symbol;
-    using SymbolTable = std::map<std::string, Symbol*>;
     class Instruction;
     
     class Section;
@@ -29,6 +33,8 @@ namespace ss {
     class BWLDirective;
     class Operand;
     class Relocation;
+    class MappedFile;
+    class ObjectCache;
 
     class Assembler {
     public:
@@ -38,11 +44,61 @@ namespace ss {
 
         static Assembler* getInstance(std::string& inputFile, std::string& outputFile, unsigned short startAddress);
 
+        //Assembles source in memory, nothing is written to files.
+        //Source is not copied, it has to outlive the assembler.
+        static Assembler* getInstance(StringView source, unsigned short startAddress);
+
+        //Object file after assemble, same bytes as written to the output file.
+        const std::vector<char>& getObject() const { return this->object; }
+
+        //Encodes every line as soon as it is parsed, label references are patched at the end.
+        void setOnePass(bool onePass);
+
+        //Writes text listing of sections, symbols and relocations next to the object.
+        //Assembler working in memory has no listing file, so it writes none.
+        void setListing(bool listing);
+
+        //Runs peephole optimizer over text between the passes, assembling is always done in two passes then.
+        void setOptimize(bool optimize);
+
+        //Object is taken from the cache if the same source was assembled before, and stored otherwise.
+        void setCache(ObjectCache* cache);
+
         ~Assembler();
     private:
 
+        //Label reference whose value is written once all labels are known.
+        struct Fixup {
+            Section* section;
+            size_t position;
+            size_t locationCounter;
+            std::string label;
+            int lineNumber;
+            StringView line;
+            bool pcRel;
+            DirectiveType type;
+        };
+
+        //IR node with the source line it was parsed from, kept for error reporting.
+        //Line is a view into the mapped input.
+        template<typename T>
+        struct SourceNode {
+            T* node;
+            int lineNumber;
+            StringView line;
+            //Label is defined right before the node, so it can be reached by a jump.
+            bool labelled;
+        };
+
+        //Change of one text node made by the optimizer, applied when the source is parsed again.
+        struct Rewrite {
+            bool drop = false;
+            //Replacement instruction, empty to keep the one in the source.
+            std::string text;
+        };
+
         //Private constructor for controlled creation of assembler.
-        Assembler(std::ifstream* in, std::ofstream* out, std::ofstream* outPretty, unsigned short startAddress);
+        Assembler(MappedFile* in, StringView source, std::ofstream* out, const std::string& listingFile, unsigned short startAddress);
 
         //Method that does the first pass.
         void firstPass();
@@ -50,14 +106,23 @@ namespace ss {
         //Method that does the second pass.
         void secondPass();
 
+        //Builds object file in memory.
         void writeOutput();
 
+        //Writes object to output file, if there is one.
+        void writeObject();
+
         void writePrettyOutput();
 
+        void writeBytes(std::ostream& out, const std::string& header, const std::vector<char>& bin);
+
+        void writeRelocations(std::ostream& out, const std::string& header, const std::vector<Relocation>& relocations);
+
         void changeSection(const std::string& sectionName, SectionType sectionType, Access access, int locationCounter, Section*& previousSection, Section*& currentSection);
         
         //Method that parse directive from line.
-        void parseDirective(const std::string& line, const std::string& directive, const int lineNumber, int& locationCounter, Section* currentSection);
+        //Returns directive that has to be encoded, or nullptr if there is none.
+        Directive* parseDirective(const std::string& line, const std::string& directive, const int lineNumber, int& locationCounter, Section* currentSection);
         
 
         //method that gets directive parameters
@@ -66,39 +131,86 @@ namespace ss {
         //Method that gets directive.
         std::string getDirective(const std::string line) const;
         
-        static void initStatic();
 
-        static bool checkReserved(std::string label);
+        short resolveLabel(const size_t& locationCounter, Section* current, const std::string label, const int lineNumber, StringView line, const bool pcRel = false);      
+        short resolveDataLabel(const size_t& locationCounter, Section* current, const std::string label, DirectiveType type, const int lineNumber, StringView line);
+
+        //Patches label references recorded during one pass assembling.
+        void resolveFixups();
+
+        //Finds rewrites of parsed text, returns false if there are none.
+        bool optimizeText();
 
-        short resolveLabel(const size_t& locationCounter, Section* current, const std::string label, const int lineNumber, const bool pcRel = false);      
-        short resolveDataLabel(const size_t& locationCounter, Section* current, const std::string label, BWLDirective* bwl, const int lineNumber);
+        //Label with given symbol number points to the next text node.
+        void setLabelNode(unsigned int no);
+
+        //Forgets everything first pass made, so the source can be parsed again.
+        void reset(const Arena::Mark& start);
         
         void assembleTextSection(Section* current, size_t& locationCounter);       
         void assembleDataSection(Section* current, size_t& locationCounter);      
         void assembleRODataSection(Section* current, size_t& locationCounter);
 
+        void encodeInstruction(Instruction* instr, Section* current, size_t& locationCounter, const int lineNumber, StringView line);
+        void encodeDirective(Directive* d, Section* current, size_t& locationCounter, const int lineNumber, StringView line);
+
         void cleanLocalSymbols();
         void copy(const Assembler&);
         void move(Assembler&);
 
         bool getImmediateValue(const std::string strVal, short& immed);
 
-        char getOperandCode(Operand* op, Section* current, Instruction* i, const size_t& locationCounter, short& secondHalf, const int lineNumber);
+        char getOperandCode(Operand* op, Section* current, Instruction* i, const size_t& locationCounter, short& secondHalf, const int lineNumber, StringView line);
 
-        std::ifstream *input;
+        //Null when source is given in memory.
+        MappedFile *input;
+        //Whole source, view into input mapping or into the buffer given by the caller.
+        StringView source;
+
+        //Null when object is kept only in memory.
         std::ofstream *output;
-        std::ofstream *objdumpOut;
+        std::vector<char> object;
+
+        //Text listing of the object, written only if it is requested.
+        std::string listingFile;
+        bool listing = false;
+
+        ObjectCache* cache = nullptr;
 
         short startAddress;
         
         bool canAlign = true;
 
-        std::map<std::string, Symbol*> symbolTable;
+        //Line parsed in the first pass, trimmed view into the mapped input.
+        StringView sourceLine;
+
+        bool onePass = false;
+        bool deferLabels = false;
+
+        bool optimize = false;
+        //Indexed by position of the node in the source text, counting the dropped ones.
+        //Rewrites of every round are kept, so later rounds see the code earlier ones made.
+        std::vector<Rewrite> rewrites;
+        size_t textNodes = 0;
+        //Source position of every parsed text node.
+        std::vector<size_t> textIndex;
+        //Text node every label points to, indexed by symbol number, NO_NODE for other symbols.
+        std::vector<size_t> labelNodes;
+        bool labelled = false;
+        std::vector<Fixup> fixups;
+
+        //Owns symbols, instructions, their operands and directives.
+        Arena arena;
+
+        SymbolTable symbolTable;
+
+        //Number given to the next symbol, in order of definition.
+        unsigned int symbolCounter = 0;
         
-        std::map<int, std::string> lines;        
-        std::map<int, Instruction*> instructions;        
-        std::map<int, Directive*> data;
-        std::map<int, Directive*> roData;
+        //Nodes are in source order.
+        std::vector<SourceNode<Instruction>> instructions;
+        std::vector<SourceNode<Directive>> data;
+        std::vector<SourceNode<Directive>> roData;
         
         std::vector<char> textBin;
         std::vector<char> dataBin;
@@ -108,16 +220,6 @@ namespace ss {
         std::vector<Relocation> relData;
         std::vector<Relocation> relROData;
 
-        std::list<std::string> txtRelData;
-        std::list<std::string> txtRelText;
-        std::list<std::string> txtRelROData;
-
-        std::string textOut;
-        std::string dataOut;
-        std::string roDataOut;
-
-        static std::map<std::string, char> reservedWords;
-
         SectionType sectionOrder[4] = {SectionType::UDF, SectionType::UDF, SectionType::UDF, SectionType::UDF};
         char sectionCounter = 0;
         //std::regex labelRegex;
@@ -4,7 +4,7 @@
 #include "asm_declarations.h"
 #include "operand.h"
 #include "utils.h"
-#include <list>
+#include <vector>
 
 namespace ss {
     class Directive {
@@ -52,14 +52,14 @@ namespace ss {
             this->operands.push_back(op);
         }
         
-        const std::list<std::string>& getOperands() const {
+        const std::vector<std::string>& getOperands() const {
             return operands;
         }
 
         ~BWLDirective() {}
     private:
 
-        std::list<std::string> operands;
+        std::vector<std::string> operands;
     };
 
     class AlignDirective :public Directive {
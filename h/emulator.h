@@ -6,6 +6,9 @@
 #include <thread>
 #include <queue>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <ostream>
 
 #define PC 7
 #define SP 6
@@ -45,6 +48,15 @@
 #define MOST_SIGNIFICANT_BIT 0x8000
 #define LEAST_SIGNIFICANT_BIT 0x0001
 #define TIMER_INTERRUPT
+
+//Even addresses are read and written as whole words instead of byte by byte. Guest memory
+//is little endian, so whole words are only used on little endian hosts.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ALIGNED_FAST_PATH
+#endif
+
+//Number of instructions retired between two watchdog checks.
+#define WATCHDOG_INTERVAL 4096
 namespace ss {
 typedef unsigned short Address;
     struct CPU {
@@ -57,6 +69,22 @@ typedef unsigned short Address;
         Address ir1;
     };
 
+    //Limits for one guest run, zero means unlimited.
+    struct RunLimits {
+        unsigned long long instructions = 0;
+        unsigned long long milliseconds = 0;
+        unsigned long long outputBytes = 0;
+    };
+
+    enum StopReason : char {
+        NOT_STOPPED,
+        HALTED,
+        EXCEPTION,
+        INSTRUCTION_LIMIT,
+        TIME_LIMIT,
+        OUTPUT_LIMIT
+    };
+
 
     class Emulator {
     public:
@@ -70,6 +98,27 @@ typedef unsigned short Address;
         static void keyboard(Emulator* emulator);
         bool isRunning() const { return this->running; }
 
+        void setLimits(const RunLimits& limits) { this->limits = limits; }
+
+        StopReason getStopReason() const { return this->stopReason; }
+
+        unsigned long long getRetiredInstructions() const;
+
+        void dumpState(std::ostream& os) const;
+
+        //Program output goes to the stream instead of standard output.
+        void setOutput(std::ostream& output) { this->output = &output; }
+
+        //Interactive run reads keyboard from the terminal. Other runs get no keyboard
+        //interrupts and don't wait for a key at the end, so emulators can run in any thread.
+        void setInteractive(bool interactive) { this->interactive = interactive; }
+
+        //Counts executed instructions by address while running.
+        void setProfiling(bool profiling);
+
+        //Writes execution counts of code symbols, one symbol with its count per line.
+        void writeProfile(std::ostream& os) const;
+
         ~Emulator();
     private:
 
@@ -78,6 +127,10 @@ typedef unsigned short Address;
         void executeInstruction();
         void interrupt();
 
+        void watchdog();
+        unsigned long nextWatchdogInterval() const;
+        void stop(StopReason reason);
+
         void fetchOperand(short& writeReg, short opAddr, short opAddrShift, short opReg, short opRegShift, InstructionCode opCode, AddressingCode addresing);
         void storeOperand(InstructionCode opCode);
         void setZN();
@@ -95,7 +148,13 @@ typedef unsigned short Address;
         void registerInterrupt(InterruptType type);
 
         bool access(Address address, Access type);
-        Address swapBytes(const Address bytes) const;
+
+        //Converts first words of instructions from big endian image order to host order.
+        void normalizeCode();
+        Address instructionSize(const Address firstHalf) const;
+
+        //Joins adjacent limits, so access checks look at fewer ranges.
+        static void mergeLimits(std::vector<Limit>& limits);
 
         Address getMemoryValue(char* memoryLocation, Access type);
         void setMemoryValue(char* memoryLocation, short& value);
@@ -114,9 +173,28 @@ typedef unsigned short Address;
         std::mutex writeMtx;
         std::queue<InterruptType> interruptBuffer;
         std::mutex mtx;
+        std::condition_variable stopCv;
+
+        RunLimits limits;
+        StopReason stopReason;
+
+        //Countdown register, watchdog is called when it reaches zero.
+        unsigned long countdown;
+        unsigned long countdownStart;
+        unsigned long long retired;
+        unsigned long long outputBytes;
+        //Output limit was hit, run stops at the next watchdog check.
+        bool outputLimitReached;
+        std::chrono::steady_clock::time_point startTime;
 
         Executable* exe;
 
+        std::ostream* output;
+        bool interactive;
+
+        //Execution count for every address, empty when not profiling.
+        std::vector<unsigned long long> execCounts;
+
 
     };
 
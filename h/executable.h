@@ -1,22 +1,37 @@
 #ifndef _SS_EXECUTABLE_H_
 #define _SS_EXECUTABLE_H_
 #include <vector>
+#include <string>
+#include <cstddef>
 
 struct Limit {
     unsigned short high;
     unsigned short low;
+    //Address of the first instruction, text can begin with .align padding. Equal to low
+    //for data limits.
+    unsigned short first;
 
     bool operator< (const Limit& l) {
         return low < l.low;
     }
 };
 
+//Code symbol of linked program, used to attribute execution counts.
+struct ExecutableSymbol {
+    std::string name;
+    unsigned short address;
+};
+
 struct Executable {
-    char* content;
+    char* content = nullptr;
+    //Non zero when content is mapped from an image file instead of allocated.
+    size_t mappedSize = 0;
     unsigned short startAddress;
     std::vector<Limit> ex;
     std::vector<Limit> rw;
     std::vector<Limit> rd;
+    //Sorted by address.
+    std::vector<ExecutableSymbol> symbols;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef _SS_EXECUTABLE_IMAGE_H_
+#define _SS_EXECUTABLE_IMAGE_H_
+
+#include <string>
+#include "executable.h"
+
+#define IMAGE_MAGIC "SSEX"
+#define IMAGE_VERSION 3
+#define IMAGE_CONTENT_SIZE 0x10000
+
+namespace ss {
+
+    //Header written right after the memory content, followed by ex, rw and rd limits.
+    //Limits are followed by symbol count and symbols, each stored as address, name length
+    //and name. Images older than version 3 have shorter limits and are not loaded.
+    struct ImageHeader {
+        char magic[4];
+        unsigned short version;
+        unsigned short startAddress;
+        unsigned short exNum;
+        unsigned short rwNum;
+        unsigned short rdNum;
+    };
+
+    //Linked program stored as a file. Memory content is at the beginning of the file
+    //so it can be mapped directly as emulator memory.
+    class ExecutableImage {
+    public:
+        static void write(const Executable* e, const std::string& file);
+
+        static Executable* load(const std::string& file);
+
+        static bool isImage(const std::string& file);
+
+        //Frees executable and its content, whether it was mapped or allocated.
+        static void release(Executable* e);
+    };
+}
+
+#endif
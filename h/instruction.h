@@ -1,20 +1,21 @@
 #ifndef _SS_INSTRUCTION_H_
 #define _SS_INSTRUCTION_H_
 #include <string>
-#include <regex>
 #include "asm_declarations.h"
 
 
 
 namespace ss {
     class Operand;
+    class Arena;
     
     class Instruction {
     public:
         Instruction() : size(2), operand1(nullptr), operand2(nullptr) {}
         Instruction(size_t size) 
             : operand1(nullptr), operand2(nullptr), instruction(InstructionCode::ALIGN_INST), size(size) {}
-        void parseInstruction(std::string, int);
+        //Operands are created in the arena and live as long as it does.
+        void parseInstruction(std::string, int, Arena& arena);
 
         Operand* getOperand1() const {
             return this->operand1;
@@ -39,11 +40,7 @@ namespace ss {
 
 
         static const char operandNumber[21]; 
-
-        ~Instruction();
     private:
-        static std::regex al, eq, ne, gt, unc;
-
         Operand* parseOperand(std::string) throw();
         
         InstructionCode instruction;
@@ -0,0 +1,45 @@
+#ifndef _SS_KEYWORDS_H_
+#define _SS_KEYWORDS_H_
+
+#include "string_view.h"
+#include "asm_declarations.h"
+
+//Register number of psw, r0-r7 are 0-7, pc is r7 and sp is r6.
+#define PSW_REGISTER 8
+
+namespace ss {
+
+    enum DirectiveCode : char {
+        GLOBAL_DIR,
+        TEXT_DIR,
+        DATA_DIR,
+        RODATA_DIR,
+        BSS_DIR,
+        CHAR_DIR,
+        WORD_DIR,
+        LONG_DIR,
+        SKIP_DIR,
+        ALIGN_DIR,
+        END_DIR,
+        UNKNOWN_DIR
+    };
+
+    //Lookups in perfect hash tables checked at compile time, see keywords.cpp.
+    //Every lookup hashes the word once and compares it with a single table entry.
+    class Keywords {
+    public:
+        //Lowercase mnemonic without condition suffix.
+        static bool mnemonic(StringView text, InstructionCode& code);
+
+        static bool condition(StringView text, ConditionCode& code);
+
+        static bool registerNumber(StringView text, char& number);
+
+        static DirectiveCode directive(StringView text);
+
+        //Registers and mnemonics, with or without condition suffix, cannot be used as labels.
+        static bool isReserved(StringView label);
+    };
+}
+
+#endif
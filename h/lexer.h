@@ -0,0 +1,69 @@
+#ifndef _SS_LEXER_H_
+#define _SS_LEXER_H_
+
+#include "string_view.h"
+#include "asm_declarations.h"
+
+namespace ss {
+
+    enum TokenType : char {
+        INVALID_TOKEN,
+        REGISTER_TOKEN,     // r3, psw, pc, sp
+        REGIND_DEC_TOKEN,   // r4[32]
+        REGIND_LAB_TOKEN,   // r5[x]
+        LABEL_TOKEN,        // x
+        LABEL_VALUE_TOKEN,  // &x
+        PCREL_TOKEN,        // $x
+        LOCATION_TOKEN,     // *20
+        DECIMAL_TOKEN,      // -20
+        DIRECTIVE_TOKEN     // .word
+    };
+
+    //Word of assembler source, text is a view into the classified string.
+    struct Token {
+        TokenType type;
+        StringView text;
+    };
+
+    //Classifies words of assembler source in one pass without allocating.
+    //Accepts exactly what the regular expressions used before it accepted, including
+    //any character in place of the dot in section names (xbss is a valid label).
+    class Lexer {
+    public:
+        static Token operand(StringView text);
+
+        //Directive name at the beginning of the line, up to the first space.
+        static Token directive(StringView line);
+
+        //Splits 2 to 4 letters long mnemonic from its al, eq, ne or gt suffix.
+        static bool mnemonic(StringView text, StringView& base, ConditionCode& condition);
+
+        static bool isLabel(StringView text);
+
+        static bool isDecimal(StringView text);
+
+    private:
+        static bool isLetter(char c) { return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')); }
+
+        static bool isDigit(char c) { return (c >= '0') && (c <= '9'); }
+
+        static bool isWordChar(char c) { return isLetter(c) || isDigit(c) || (c == '_'); }
+
+        static bool isBlank(char c) { return (c == ' ') || (c == '\t'); }
+
+        static bool isEmpty(char c) { return isBlank(c) || (c == '\n') || (c == '\v') || (c == '\f') || (c == '\r'); }
+
+        static bool isIdentifier(StringView text);
+
+        static bool isNumber(StringView text);
+
+        static bool isSectionName(StringView text);
+
+        static bool isRegister(StringView text);
+
+        //Matches r[0-7] followed by bracketed offset, see lexer.cpp for accepted forms.
+        static TokenType registerIndirect(StringView text);
+    };
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef _SS_LINK_STATE_H_
+#define _SS_LINK_STATE_H_
+
+#include <string>
+#include <vector>
+#include "elf.h"
+#include "asm_declarations.h"
+
+#define LINK_STATE_MAGIC "SSLS"
+#define LINK_STATE_VERSION 2
+
+namespace ss {
+
+    struct StateInput {
+        std::string path;
+        unsigned long long hash;
+        bool archive;
+    };
+
+    //Placed section, capacity is the space up to the next section.
+    struct StateSection {
+        SectionType type;
+        ElfWord addr;
+        ElfWord size;
+        ElfWord capacity;
+        ElfWord align;
+    };
+
+    struct StateSymbol {
+        std::string name;
+        SectionType section;
+        ElfWord address;
+    };
+
+    //Relocation with its addend, the value assembler left in the patched word. Target is
+    //a named symbol, or section of the same unit when name is empty.
+    struct StateRelocation {
+        ElfWord address;
+        RelocationType type;
+        SectionType section;
+        std::string name;
+        ElfWord addend;
+    };
+
+    //Linked object file, member is empty unless it was taken from an archive.
+    struct StateUnit {
+        int input;
+        std::string member;
+        std::vector<StateSection> sections;
+        std::vector<StateSymbol> symbols;
+        std::vector<StateRelocation> relocations;
+    };
+
+    //Everything incremental relink needs from the previous link, stored next to the image.
+    class LinkState {
+    public:
+        LinkState() : options(0), imageHash(0) {}
+
+        void write(const std::string& file) const;
+
+        //Returns false when file doesn't exist or is not a valid state.
+        bool read(const std::string& file);
+
+        unsigned long long options;
+        unsigned long long imageHash;
+        std::vector<StateInput> inputs;
+        std::vector<StateUnit> units;
+    };
+}
+
+#endif
@@ -2,32 +2,187 @@
 #define _SS_LINKER_H
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <memory>
+#include <functional>
 #include "linking_file_data.h"
+#include "archive.h"
 #include "elf.h"
 #include "executable.h"
+#include "link_state.h"
 
 namespace ss {
+    //Times of link phases in milliseconds, and sizes of linked program.
+    struct LinkStats {
+        double parse = 0;
+        double symbols = 0;
+        double merge = 0;
+        double relocation = 0;
+        double limits = 0;
+        //Zero unless incremental link was tried.
+        double relink = 0;
+        double total = 0;
+        size_t files = 0;
+        size_t sections = 0;
+        size_t relocations = 0;
+        size_t imageSize = 0;
+        //Peak resident memory in kilobytes.
+        long peakMemory = 0;
+    };
+
+    //Object file or archive in memory, name is used in messages and the map.
+    //Data is not copied, it has to stay alive until linking is done.
+    struct LinkInput {
+        std::string name;
+        const char* data;
+        size_t size;
+    };
+
     class Relocation;
+    class ThreadPool;
     class Linker {
     public:
         Linker();
+        ~Linker();
         Executable* linkFiles(std::vector<std::string>&);
         
         Executable* linkFiles(const char* files[], int num);
+
+        //Links inputs that are already in memory, like objects made by Assembler::getObject.
+        //Incremental link needs input files, so it is not supported.
+        Executable* linkObjects(const std::vector<LinkInput>& inputs);
+
+        //Number of threads used for parsing and relocation, zero means one per hardware thread.
+        void setThreads(unsigned int threads);
+
+        //Drops sections not reachable from START.
+        void setGcSections(bool gcSections);
+
+        //Keeps addresses given by the assembler instead of packing sections.
+        void setFixedPlacement(bool fixedPlacement);
+
+        //Input of this name holds the IV table, its data stays where the assembler placed it.
+        //Without it every section is relocated and no data is kept for interrupt vectors.
+        void setIvTable(const std::string& file);
+
+        //Reads execution counts written by emulator, hot code is placed first.
+        void setProfile(const std::string& file);
+
+        //Keeps link state next to image and patches the image in place on next link.
+        void setIncremental(const std::string& image);
+
+        //True when last link patched previous image instead of linking everything.
+        bool isRelinked() const { return relinked; }
+
+        //Writes addresses of files, sections and symbols of linked program to the file.
+        void setMap(const std::string& file);
+
+        const LinkStats& getStats() const { return stats; }
         
     private:
-        void readRelocationTable(std::ifstream&, SectionHeader&, std::vector<Relocation>&);
+        //Input i is named files[i] and its data is given by open(i).
+        Executable* linkAll(const std::vector<std::string>& files, const std::function<MappedFile*(size_t)>& open);
 
         //This method parses one binary file and returns it's ELF format representation.
-        LinkingFileData* parseFile(const std::string&);
+        LinkingFileData* parseFile(const std::string&, std::unique_ptr<MappedFile> mapping);
+
+        LinkingFileData* parseMember(const Archive& archive, size_t member);
+
+        //Pulls archive members defining undefined symbols until no new member is needed.
+        void extractMembers(ThreadPool& pool);
     
-        void resolveSectionSymbols(char* mergedContent, std::vector<Relocation>& rel, LinkingFileData* file, SectionType section);
+        void resolveSectionSymbols(char* mergedContent, LinkingFileData* file, const InputSection& section);
      
-        SymTabEntry* findSymbolById(int id, LinkingFileData* file);
+        //Returns symbol referenced by id in file, and file that defines it through owner.
+        const SymTabEntry* findSymbolById(int id, LinkingFileData* file, LinkingFileData*& owner);
+
+        //Address of symbol after its section has been placed.
+        ElfWord symbolAddress(const SymTabEntry* symbol, LinkingFileData* owner);
+
+        //Marks sections reachable through relocations from START and the IV table.
+        void markLiveSections(LinkingFileData* startFile, const SymTabEntry* start);
+
+        //First data or rodata section of the IV table input, null for other files.
+        const InputSection* ivTableOf(const LinkingFileData* file) const;
+
+        bool inIvTable(const LinkingFileData* file, const InputSection& section) const {
+            return &section == this->ivTableOf(file);
+        }
+
+        //Finds index of the IV table input.
+        void resolveIvTable(const std::vector<std::string>& files);
 
-        LinkingFileData merged;
+        //Checks that IV table input is linked and its table is at the beginning of memory.
+        //With automatic placement no other input may have data assembled in the IV table.
+        void checkIvTable() const;
+
+        //Non empty data or rodata assembled below the end of the IV table.
+        static bool inIvTableRange(const InputSection& section);
+
+        //Packs live sections after the IV table, below the stack.
+        void placeSections();
+
+        //Code symbols with their final addresses, for profiling.
+        void collectSymbols(Executable* e);
+
+        static void addLimit(Executable* e, SectionType type, ElfWord addr, ElfWord size, ElfWord align);
+        //Adds IO and stack limits and sorts all of them.
+        static void finishLimits(Executable* e);
+
+        static bool isSectionName(StringView name);
+
+        //Writes relocated value of one word, addend is the value assembler left in it.
+        static void patchWord(char* content, ElfWord address, RelocationType type, ElfWord target, ElfWord addend);
+
+        //Patches previous image for changed inputs, returns null when full link is needed.
+        Executable* relink(const std::vector<std::string>& files);
+
+        void saveState(const Executable* e);
+
+        //Records placed sections, symbols and relocations of every linked file.
+        void collectLayout(const std::vector<std::string>& files);
+
+        void writeMap(const Executable* e);
+
+        unsigned long long optionsHash() const;
+
+        //Builds name index of one parsed file.
+        void indexFile(LinkingFileData* file);
+
+        unsigned int internName(StringView name);
+
+        //Every distinct symbol name gets a dense id.
+        //Names are views into parsed files, which live as long as the linker.
+        std::unordered_map<StringView, unsigned int, StringViewHash> nameIds;
+
+        //Exported symbols indexed by interned name id.
+        std::vector<const SymTabEntry*> exports;
+        std::vector<LinkingFileData*> exportFiles;
 
         std::vector<LinkingFileData*> parsedFiles;
+
+        //Archives given as input, members point into their mappings.
+        std::vector<std::unique_ptr<Archive>> archives;
+        //Command line index of every archive.
+        std::vector<int> archiveInputs;
+
+        unsigned int threads;
+        bool gcSections;
+        bool fixedPlacement;
+        std::string ivTableFile;
+        //Input index of the IV table file, -1 when there is none.
+        int ivTableInput;
+
+        //Execution count of every profiled symbol.
+        std::unordered_map<std::string, unsigned long long> profile;
+        unsigned long long profileHash;
+
+        std::string incrementalImage;
+        bool relinked;
+        LinkState layout;
+
+        std::string mapFile;
+        LinkStats stats;
     };
 }
 
@@ -3,31 +3,49 @@
 
 #include "elf.h"
 #include <vector>
-#include <map>
+#include <string>
+#include <memory>
 #include "relocation.h"
+#include "array_view.h"
+#include "string_view.h"
+#include "mapped_file.h"
 namespace ss {
     
     class SectionContent {
     public:
-        char* content = nullptr;
+        const char* content = nullptr;
         size_t size = 0;
         size_t startAddr = 0;
 
 
         SectionContent() {}
+    };
 
-        ~SectionContent() {
-            //delete[] content;
-        }
-    private:
+    //Content section of a parsed file and where it ends up in the image.
+    class InputSection {
+    public:
+        SectionType type;
+        const char* content = nullptr;
+        ElfWord size = 0;
+        ElfWord align = 1;
+        //Address assigned by the assembler, symbol offsets are based on it.
+        ElfWord originalAddr = 0;
+        ElfWord addr = 0;
+        bool live = true;
+        //Executions of code in section according to profile.
+        unsigned long long heat = 0;
+        ArrayView<Relocation> relocations;
 
-        void copy(SectionContent& c) {
-            this->content = c.content;
-            this->size = c.size;
-            this->startAddr = c.startAddr;
+        InputSection() {}
+
+        //Moves address from assembler placement to linker placement.
+        ElfWord relocate(ElfWord address) const {
+            return (ElfWord)(address - originalAddr + addr);
         }
     };
 
+    //Parsed object file. Tables are views into the mapped file, so the file data
+    //must stay alive as long as they are used.
     class LinkingFileData {
     public:
         LinkingFileData() :  containsStart(false){}
@@ -37,26 +55,41 @@ namespace ss {
         // }
         
         ELFHeader header;
-        std::vector<SectionHeader> secHeaders;
-        std::vector<Relocation> relText;
-        std::vector<Relocation> relData;
-        std::vector<Relocation> relRoData;
-        std::vector<std::string> strTab;
-        std::vector<SymTabEntry> symbolTable;
+        ArrayView<SectionHeader> secHeaders;
+        ArrayView<Relocation> relText;
+        ArrayView<Relocation> relData;
+        ArrayView<Relocation> relRoData;
+        std::vector<StringView> strTab;
+        ArrayView<SymTabEntry> symbolTable;
         std::vector<SectionContent> content;
 
-        std::map<std::string, SymTabEntry*> symbolMap;
+        //Text, rodata, data and bss sections in file order, built after parsing.
+        std::vector<InputSection> sections;
+
+        InputSection* findSection(SectionType type) {
+            for (int i = 0; i < sections.size(); ++i) {
+                if (sections[i].type == type) return &sections[i];
+            }
+            return nullptr;
+        }
+
+        //Symbol table entries indexed by symbol id, built by the reader.
+        std::vector<const SymTabEntry*> idIndex;
+        //Interned name id for every string table entry.
+        std::vector<unsigned int> nameIds;
         
         std::string fileName;
+        //Index of command line input the file comes from, and its archive member name.
+        int input = -1;
+        std::string member;
         bool containsStart;
         size_t cumulativeSize = 0;
 
-        ~LinkingFileData() {
-            for(int i = 0; i < content.size(); i++) {
-                delete[] content[i].content;
-                content[i].content = nullptr;
-            }
-        }
+        //Mapping that views point into, null when the caller owns the buffer.
+        std::unique_ptr<MappedFile> mapping;
+
+        //Copies of tables that were not aligned for direct access in the mapping.
+        std::vector<std::unique_ptr<char[]>> alignedCopies;
     };
 }
-#endif
\ No newline at end of file
+#endif
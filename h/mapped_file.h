@@ -0,0 +1,35 @@
+#ifndef _SS_MAPPED_FILE_H_
+#define _SS_MAPPED_FILE_H_
+
+#include <string>
+#include <cstddef>
+
+namespace ss {
+
+    //Read only private mapping of a whole file.
+    class MappedFile {
+    public:
+        MappedFile(const std::string& path);
+
+        //Views data that is already in memory, it is owned by the caller and not unmapped.
+        MappedFile(const char* data, size_t size) : content((char*)data), length(size), open(true), mapped(false) {}
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return open; }
+
+        const char* data() const { return content; }
+
+        size_t size() const { return length; }
+
+        ~MappedFile();
+    private:
+        char* content;
+        size_t length;
+        bool open;
+        bool mapped;
+    };
+}
+
+#endif
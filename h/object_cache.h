@@ -0,0 +1,77 @@
+#ifndef _SS_OBJECT_CACHE_H_
+#define _SS_OBJECT_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include "string_view.h"
+
+//Default limit of cache directory size in bytes.
+#define OBJECT_CACHE_SIZE (64ULL * 1024 * 1024)
+
+//Temporary file left by a writer that is still alive is removed only after this many seconds.
+#define OBJECT_CACHE_TMP_AGE (60 * 60)
+
+namespace ss {
+
+    struct CacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stored = 0;
+        size_t evicted = 0;
+        //Bytes left in the cache after eviction.
+        unsigned long long size = 0;
+    };
+
+    //Everything an object is assembled from. It is stored with the entry and compared on fetch,
+    //so two sources with the same key never get each other's object.
+    struct CacheSource {
+        StringView source;
+        short startAddress;
+        bool optimize;
+    };
+
+    //Directory of assembled objects named by hash of source, start address and assembler version.
+    //Entry is one <key>.entry file holding the source, the object and optional listing. It is written
+    //under a temporary name and renamed, so assemblers in other threads and processes never see a
+    //partial entry.
+    class ObjectCache {
+    public:
+        //Creates the directory if it doesn't exist.
+        ObjectCache(const std::string& directory, unsigned long long maxSize = OBJECT_CACHE_SIZE);
+
+        ObjectCache(const ObjectCache&) = delete;
+        ObjectCache& operator=(const ObjectCache&) = delete;
+
+        //Optimized object of the same source is a different entry.
+        static unsigned long long key(const CacheSource& source);
+
+        //Reads cached object and copies listing to listing file, unless listing file is empty.
+        //Returns false if entry, or its listing when it is needed, is not cached, or the entry was
+        //made from another source.
+        bool fetch(unsigned long long key, const CacheSource& source, std::vector<char>& object, const std::string& listingFile);
+
+        //Failing to store is not an error, the object is only assembled again next time.
+        void store(unsigned long long key, const CacheSource& source, const std::vector<char>& object, const std::string& listingFile);
+
+        //Removes temporary files of writers that are gone, then least recently used entries until
+        //the directory fits in its size.
+        void evict();
+
+        CacheStats getStats();
+    private:
+        std::string entry(unsigned long long key) const;
+
+        //Writes file under temporary name and renames it.
+        bool publish(const std::string& path, const char* data, size_t size);
+
+        std::string directory;
+        unsigned long long maxSize;
+
+        std::mutex mtx;
+        CacheStats stats;
+        unsigned long long tmpCounter = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef _SS_OBJECT_READER_H_
+#define _SS_OBJECT_READER_H_
+
+#include <string>
+#include "elf.h"
+#include "array_view.h"
+#include "linking_file_data.h"
+
+namespace ss {
+
+    //Reads object file from memory. Section headers, relocations, symbols, strings and
+    //content are exposed as views into the buffer, which must outlive the file data.
+    class ObjectReader {
+    public:
+        static void read(const char* data, size_t size, const std::string& name, LinkingFileData* file);
+
+    private:
+        template<typename T>
+        static ArrayView<T> table(const char* data, size_t size, ElfWord offset, size_t count, const std::string& name, LinkingFileData* file);
+
+        static void readStringTable(const char* data, size_t size, const SectionHeader& sh, const std::string& name, LinkingFileData* file);
+    };
+}
+
+#endif
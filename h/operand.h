@@ -1,7 +1,6 @@
 #ifndef _SS_OPERAND_H_
 #define _SS_OPERAND_H_
 #include <string>
-#include <regex>
 #include "asm_declarations.h"
 
 namespace ss {
@@ -30,13 +29,6 @@ namespace ss {
     protected:
         friend class Assembler;
     private:
-        
-        static std::regex decimalRegex;
-        static std::regex regIndDecRegex;
-        static std::regex regIndLabRegex;
-        static std::regex regDirRegex;
-        static std::regex labelRegex;
-        static std::regex locationRegex;
 
         std::string text;
         OperandType type;
@@ -11,8 +11,8 @@ namespace ss {
     public:
         Section() : Symbol() {}
         Section(size_t sectionSize, Access access, unsigned short align = 0) : Symbol(), sectionSize(sectionSize), access(access), align(align), nParsed(0) {}
-        Section(size_t sectionSize, Access access, const std::string& name, SectionType section, unsigned int offset, bool local, unsigned short align = 0) 
-        : Symbol(name, section, offset, local), sectionSize(sectionSize), access(access), align(align), nParsed(0) {} 
+        Section(unsigned int no, size_t sectionSize, Access access, const std::string& name, SectionType section, unsigned int offset, bool local, unsigned short align = 0) 
+        : Symbol(no, name, section, offset, local), sectionSize(sectionSize), access(access), align(align), nParsed(0) {} 
     
         size_t getSectionSize() const  {
             return sectionSize;
@@ -11,14 +11,14 @@ namespace ss {
 
     class FileException: public std::exception {
     public:
-        FileException(const char* lineContent) :message(lineContent) {}
+        FileException(const std::string& lineContent) :message(lineContent) {}
 
         const char* what() const throw() override {
-            return message;
+            return message.c_str();
         }
 
     private:
-        const char* message;
+        std::string message;
     };
 
     class AssemblingException: public std::exception {
@@ -2,34 +2,38 @@
 #define _SS_STRING_TOKENIZER_H_
 
 #include <string>
-#include <list>
 #include "ss_exceptions.h"
+#include "string_view.h"
 using namespace std;
 
 namespace ss {
+    //Splits string on runs of delimiter characters, after trimming it.
+    //Tokens are views into the tokenized string, which must outlive them.
     class StringTokenizer {
     public:
-        StringTokenizer(const string& delimiter) : delimiter(delimiter), tokens(nullptr) {
+        StringTokenizer(const string& delimiter) : delimiter(delimiter), initialized(false), finished(true), position(0) {
             
         } 
 
-        void tokenize(const string& str);
+        void tokenize(StringView str);
 
-        bool hasNext();
+        bool hasNext() const;
 
-        string& nextToken() throw();
+        StringView nextToken();
 
-        int tokenNumber();
-        ~StringTokenizer();
+        int tokenNumber() const;
     private:
+        bool isDelimiter(char c) const;
+
         const string delimiter;
 
-        list<string> *tokens;
+        StringView text;
 
-        list<string>::iterator current;
+        bool initialized;
+        bool finished;
+        size_t position;
 
     };
 }
 
 #endif
-
@@ -0,0 +1,72 @@
+#ifndef _SS_STRING_VIEW_H_
+#define _SS_STRING_VIEW_H_
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+
+namespace ss {
+
+    //Non owning view of characters, referenced buffer must outlive the view.
+    class StringView {
+    public:
+        static const size_t npos = (size_t)-1;
+
+        StringView() : ptr(nullptr), len(0) {}
+        StringView(const char* ptr, size_t len) : ptr(ptr), len(len) {}
+        StringView(const char* str) : ptr(str), len(std::strlen(str)) {}
+        StringView(const std::string& str) : ptr(str.data()), len(str.length()) {}
+
+        const char* data() const { return ptr; }
+
+        size_t size() const { return len; }
+
+        size_t length() const { return len; }
+
+        bool empty() const { return len == 0; }
+
+        char operator[](size_t i) const { return ptr[i]; }
+
+        const char* begin() const { return ptr; }
+
+        const char* end() const { return ptr + len; }
+
+        StringView substr(size_t pos, size_t n = npos) const {
+            if (pos > len) pos = len;
+            if (n > len - pos) n = len - pos;
+            return StringView(ptr + pos, n);
+        }
+
+        int compare(StringView s) const {
+            int result = std::memcmp(ptr, s.ptr, len < s.len ? len : s.len);
+            if (result != 0) return result;
+            return len < s.len ? -1 : len > s.len ? 1 : 0;
+        }
+
+        bool operator==(StringView s) const { return (len == s.len) && (std::memcmp(ptr, s.ptr, len) == 0); }
+
+        bool operator!=(StringView s) const { return !(*this == s); }
+
+        bool operator<(StringView s) const { return compare(s) < 0; }
+
+        std::string str() const { return std::string(ptr, len); }
+
+    private:
+        const char* ptr;
+        size_t len;
+    };
+
+    //FNV-1a hash, used for hash tables keyed by views.
+    struct StringViewHash {
+        size_t operator()(StringView s) const {
+            size_t hash = 2166136261u;
+            for (size_t i = 0; i < s.size(); ++i) {
+                hash ^= (unsigned char)s[i];
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+    };
+}
+
+#endif
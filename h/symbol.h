@@ -9,12 +9,13 @@ namespace ss {
     class Section;
     class Symbol {
     public:
-        Symbol() : no(noCounter++) {
+        Symbol() : no(0) {
 
         }
 
-        Symbol(const std::string& label, SectionType section, unsigned int offset, bool local) 
-            : no(noCounter++), name(label), section(section), offset(offset), local(local) {
+        //Identifier is given by the owner of the symbol table, so separate assemblers do not share state.
+        Symbol(unsigned int no, const std::string& label, SectionType section, unsigned int offset, bool local) 
+            : no(no), name(label), section(section), offset(offset), local(local) {
 
         }
 
@@ -72,8 +73,6 @@ namespace ss {
         bool local;             //Is label local or global
 
         unsigned int no;        //Symbol identifier
-
-        static unsigned int noCounter;
     };
 }
 
@@ -0,0 +1,76 @@
+#ifndef _SS_SYMBOL_TABLE_H_
+#define _SS_SYMBOL_TABLE_H_
+
+#include <string>
+#include <vector>
+#include "string_view.h"
+
+//Initial number of slots, always a power of two.
+#define SYMBOL_TABLE_SLOTS 64
+
+namespace ss {
+
+    class Symbol;
+
+    //Symbols of one assembled file, found by name in an open addressing table with linear probing.
+    //Symbol number is its index, so symbols are also walked in order of definition.
+    //Names are interned in one pool laid out as the string table of an object, length followed by
+    //characters, so the string table is copied from the pool.
+    class SymbolTable {
+    public:
+        SymbolTable();
+
+        //Returns nullptr if there is no symbol of that name.
+        Symbol* find(StringView name) const;
+
+        //Name must not be in the table, unless its symbol was erased.
+        void insert(Symbol* symbol);
+
+        //Name stays interned, so probing for other names goes on past its slot.
+        void erase(Symbol* symbol);
+
+        //Symbol with given number, nullptr if there is none.
+        Symbol* at(unsigned int no) const {
+            return no < this->entries.size() ? this->entries[no].symbol : nullptr;
+        }
+
+        //One past the highest symbol number.
+        size_t indices() const { return this->entries.size(); }
+
+        //Symbols that are not erased.
+        size_t size() const { return this->live; }
+
+        //String table entry of the symbol with given number.
+        StringView stringTableEntry(unsigned int no) const;
+
+        //Symbols that are not erased, ordered by name.
+        std::vector<Symbol*> sortedByName() const;
+
+        void clear();
+    private:
+        struct Entry {
+            Symbol* symbol;
+            //Position of the name length in the pool.
+            size_t name;
+            size_t length;
+            size_t hash;
+        };
+
+        StringView entryName(const Entry& e) const;
+
+        //Slot that holds the name, or the empty slot where it would be placed.
+        size_t probe(StringView name, size_t hash) const;
+
+        void grow();
+
+        std::vector<Entry> entries;
+        //Entry index plus one, zero for empty slot.
+        std::vector<unsigned int> slots;
+        size_t filled = 0;
+        size_t live = 0;
+
+        std::string pool;
+    };
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef _SS_THREAD_POOL_H_
+#define _SS_THREAD_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace ss {
+
+    //Fixed set of worker threads running indexed jobs.
+    class ThreadPool {
+    public:
+        //Zero threads means one per hardware thread.
+        ThreadPool(unsigned int threads = 0);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        //Runs job(0) ... job(count - 1) and waits for all of them.
+        //If jobs throw, exception of the job with the lowest index is rethrown,
+        //so errors are reported the same way as in a sequential loop.
+        void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+        unsigned int size() const { return workers.size() + 1; }
+
+        static unsigned int defaultThreads();
+
+        ~ThreadPool();
+    private:
+        void workerLoop();
+
+        //Takes jobs of the current batch until none are left.
+        void runJobs();
+
+        std::vector<std::thread> workers;
+
+        std::mutex mtx;
+        std::condition_variable workCv;
+        std::condition_variable doneCv;
+
+        const std::function<void(size_t)>* job;
+        size_t count;
+        size_t next;
+        size_t finished;
+        unsigned long long batch;
+        bool stopping;
+
+        std::vector<std::exception_ptr> errors;
+    };
+}
+
+#endif
@@ -1,7 +1,10 @@
 #ifndef _SS_UTILS_H_
 #define _SS_UTILS_H_
 #include <string>
-#include <regex>
+#include <cstddef>
+#include "string_view.h"
+
+#define HASH_SEED 14695981039346656037ULL
 
 namespace ss {
     
@@ -13,18 +16,22 @@ namespace ss {
             std::string s(str);
             return trim(s);
         }
+
+        //Narrows the view, string of empty chars only is returned as it is.
+        static StringView trim(StringView str);
         
         static const std::string emptyChars;
                 
         static std::string& removeRepeatingChars(std::string& str, const std::string& chars = emptyChars);
 
-        static std::string removeEmptySpaces(const std::string& str);
+        static std::string& removeEmptySpaces(std::string& str);
         
         static unsigned int findNextDivisibleByPow2(unsigned int pow, unsigned int start);
 
-        static const std::string empty;
+        //64 bit FNV-1a, longer data can be hashed in parts by passing previous result as seed.
+        static unsigned long long hash(const char* data, size_t size, unsigned long long seed = HASH_SEED);
 
-        static std::regex labelRegex, decimalRegex;
+        static const std::string empty;
     };
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,377 @@
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+#include "linker.h"
+#include "link_state.h"
+#include "executable_image.h"
+#include "mapped_file.h"
+#include "ss_exceptions.h"
+#include "asm_declarations.h"
+#include "utils.h"
+using namespace ss;
+
+void Linker::setIncremental(const std::string& image) {
+    this->incrementalImage = image;
+}
+
+unsigned long long Linker::optionsHash() const {
+    //Placement depends on these options, state saved with other ones can't be reused.
+    char fixed = this->fixedPlacement ? 1 : 0;
+    unsigned long long hash = Utils::hash(this->ivTableFile.data(), this->ivTableFile.size(), this->profileHash);
+    return Utils::hash(&fixed, sizeof(fixed), hash);
+}
+
+void Linker::saveState(const Executable* e) {
+    this->layout.options = this->optionsHash();
+    this->layout.imageHash = Utils::hash(e->content, IMAGE_CONTENT_SIZE);
+
+    for (int i = 0; i < this->layout.inputs.size(); ++i) {
+        MappedFile mapping(this->layout.inputs[i].path);
+        this->layout.inputs[i].hash = Utils::hash(mapping.data(), mapping.size());
+    }
+
+    this->layout.write(this->incrementalImage + ".state");
+}
+
+void Linker::collectLayout(const std::vector<std::string>& files) {
+    LinkState& state = this->layout;
+
+    for (int i = 0; i < files.size(); ++i) {
+        StateInput input;
+        input.path = files[i];
+        input.hash = 0;
+        input.archive = std::find(archiveInputs.begin(), archiveInputs.end(), i) != archiveInputs.end();
+        state.inputs.push_back(input);
+    }
+
+    //Section can grow up to the beginning of the next one.
+    std::vector<const InputSection*> placed;
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            const InputSection& section = parsedFiles[i]->sections[j];
+            if (section.live && (section.size != 0)) {
+                placed.push_back(&section);
+            }
+        }
+    }
+    std::sort(placed.begin(), placed.end(), [](const InputSection* a, const InputSection* b) {
+        return a->addr < b->addr;
+    });
+
+    std::unordered_map<const InputSection*, ElfWord> capacity;
+    for (int i = 0; i < placed.size(); ++i) {
+        size_t next = (i + 1 < placed.size()) ? placed[i + 1]->addr : STACK_START - STACK_SIZE;
+        capacity[placed[i]] = next - placed[i]->addr;
+    }
+
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        LinkingFileData* file = parsedFiles[i];
+        StateUnit unit;
+        unit.input = file->input;
+        unit.member = file->member;
+
+        for (int j = 0; j < file->sections.size(); ++j) {
+            const InputSection& section = file->sections[j];
+            if (!section.live) continue;
+
+            StateSection s;
+            s.type = section.type;
+            s.addr = section.addr;
+            s.size = section.size;
+            s.capacity = capacity.count(&section) != 0 ? capacity[&section] : section.size;
+            s.align = section.align;
+            unit.sections.push_back(s);
+
+            for (int k = 0; k < section.relocations.size(); ++k) {
+                const Relocation& r = section.relocations[k];
+                LinkingFileData* owner = nullptr;
+                const SymTabEntry* symbol = this->findSymbolById(r.id, file, owner);
+
+                StateRelocation rel;
+                rel.address = section.addr + r.offset;
+                rel.type = r.type;
+                rel.section = symbol->section;
+                rel.addend = (ElfWord)((section.content[r.offset] & 0xFF) | ((section.content[r.offset + 1] & 0xFF) << 8));
+                if (!Linker::isSectionName(owner->strTab[symbol->name])) {
+                    rel.name = owner->strTab[symbol->name].str();
+                }
+                unit.relocations.push_back(rel);
+            }
+        }
+
+        for (int j = 0; j < file->symbolTable.size(); ++j) {
+            const SymTabEntry& entry = file->symbolTable[j];
+            const InputSection* section = file->findSection(entry.section);
+            if ((section == nullptr) || !section->live || Linker::isSectionName(file->strTab[entry.name])) {
+                continue;
+            }
+
+            StateSymbol symbol;
+            symbol.name = file->strTab[entry.name].str();
+            symbol.section = entry.section;
+            symbol.address = this->symbolAddress(&entry, file);
+            unit.symbols.push_back(symbol);
+        }
+
+        state.units.push_back(unit);
+    }
+}
+
+Executable* Linker::relink(const std::vector<std::string>& files) {
+    LinkState state;
+    this->resolveIvTable(files);
+
+    if (!state.read(this->incrementalImage + ".state") || (state.options != this->optionsHash()) || (state.inputs.size() != files.size())) {
+        return nullptr;
+    }
+
+    //Only inputs whose content changed are parsed again.
+    std::vector<int> changed;
+    std::vector<unsigned long long> hashes(files.size());
+    std::vector<std::unique_ptr<MappedFile>> mappings(files.size());
+    for (int i = 0; i < files.size(); ++i) {
+        mappings[i].reset(new MappedFile(files[i]));
+        if (!mappings[i]->isOpen() || (files[i] != state.inputs[i].path)) {
+            return nullptr;
+        }
+
+        hashes[i] = Utils::hash(mappings[i]->data(), mappings[i]->size());
+        if (hashes[i] != state.inputs[i].hash) {
+            //Changed archive can change which members are needed.
+            if (state.inputs[i].archive || Archive::isArchive(mappings[i]->data(), mappings[i]->size())) {
+                return nullptr;
+            }
+            changed.push_back(i);
+        }
+    }
+
+    //Patched image must be the one state was saved with.
+    std::unique_ptr<char[]> content(new char[IMAGE_CONTENT_SIZE]);
+    {
+        MappedFile image(this->incrementalImage);
+        if (!image.isOpen() || (image.size() < IMAGE_CONTENT_SIZE)) {
+            return nullptr;
+        }
+        std::memcpy(content.get(), image.data(), IMAGE_CONTENT_SIZE);
+    }
+    if (Utils::hash(content.get(), IMAGE_CONTENT_SIZE) != state.imageHash) {
+        return nullptr;
+    }
+
+    std::unordered_map<std::string, ElfWord> oldAddresses;
+    for (int i = 0; i < state.units.size(); ++i) {
+        for (int j = 0; j < state.units[i].symbols.size(); ++j) {
+            oldAddresses[state.units[i].symbols[j].name] = state.units[i].symbols[j].address;
+        }
+    }
+    std::unordered_map<std::string, ElfWord> addresses(oldAddresses);
+
+    //Changed files are parsed and put in place of their previous versions.
+    std::vector<std::unique_ptr<LinkingFileData>> parsed(changed.size());
+    std::vector<int> changedUnits(changed.size(), -1);
+    std::vector<bool> unitChanged(state.units.size(), false);
+    for (int k = 0; k < changed.size(); ++k) {
+        for (int i = 0; i < state.units.size(); ++i) {
+            if ((state.units[i].input == changed[k]) && state.units[i].member.empty()) {
+                changedUnits[k] = i;
+            }
+        }
+        if (changedUnits[k] < 0) {
+            return nullptr;
+        }
+        unitChanged[changedUnits[k]] = true;
+
+        parsed[k].reset(this->parseFile(files[changed[k]], std::move(mappings[changed[k]])));
+        LinkingFileData* file = parsed[k].get();
+        file->input = changed[k];
+        StateUnit& unit = state.units[changedUnits[k]];
+
+        for (int j = 0; j < file->sections.size(); ++j) {
+            InputSection& section = file->sections[j];
+            const StateSection* old = nullptr;
+            for (int s = 0; s < unit.sections.size(); ++s) {
+                if (unit.sections[s].type == section.type) old = &unit.sections[s];
+            }
+
+            //Full link reports data in the IV table of an input other than the IV table.
+            if (!this->fixedPlacement && Linker::inIvTableRange(section) && !this->inIvTable(file, section)) {
+                return nullptr;
+            }
+
+            //Section must fit in its previous place and keep its alignment there.
+            if ((old == nullptr) || ((section.size > old->capacity) && (section.size > old->size))) {
+                return nullptr;
+            }
+            if (this->fixedPlacement || this->inIvTable(file, section)) {
+                if (section.originalAddr != old->addr) return nullptr;
+            }
+            else if ((old->addr - section.originalAddr) % section.align != 0) {
+                return nullptr;
+            }
+
+            section.addr = old->addr;
+        }
+
+        for (int j = 0; j < unit.symbols.size(); ++j) {
+            addresses.erase(unit.symbols[j].name);
+        }
+    }
+
+    std::vector<std::vector<StateSymbol>> newSymbols(changed.size());
+    for (int k = 0; k < changed.size(); ++k) {
+        LinkingFileData* file = parsed[k].get();
+        for (int j = 0; j < file->symbolTable.size(); ++j) {
+            const SymTabEntry& entry = file->symbolTable[j];
+            if ((entry.section == SectionType::UDF) || Linker::isSectionName(file->strTab[entry.name])) {
+                continue;
+            }
+
+            StateSymbol symbol;
+            symbol.name = file->strTab[entry.name].str();
+            symbol.section = entry.section;
+            symbol.address = this->symbolAddress(&entry, file);
+
+            //Multiple definitions are reported by full link.
+            if (addresses.count(symbol.name) != 0) {
+                return nullptr;
+            }
+            addresses[symbol.name] = symbol.address;
+            newSymbols[k].push_back(symbol);
+        }
+    }
+
+    if (addresses.count("START") == 0) {
+        return nullptr;
+    }
+
+    //Symbols removed from changed files must not be used by the rest of the program.
+    for (int i = 0; i < state.units.size(); ++i) {
+        if (unitChanged[i]) continue;
+        for (int j = 0; j < state.units[i].relocations.size(); ++j) {
+            const StateRelocation& r = state.units[i].relocations[j];
+            if (!r.name.empty() && (addresses.count(r.name) == 0)) {
+                return nullptr;
+            }
+        }
+    }
+
+    for (int k = 0; k < changed.size(); ++k) {
+        LinkingFileData* file = parsed[k].get();
+        StateUnit& old = state.units[changedUnits[k]];
+        StateUnit unit;
+        unit.input = old.input;
+        unit.member = old.member;
+        unit.symbols = newSymbols[k];
+
+        for (int j = 0; j < old.sections.size(); ++j) {
+            std::memset(content.get() + old.sections[j].addr, 0, old.sections[j].size);
+        }
+
+        for (int j = 0; j < file->sections.size(); ++j) {
+            const InputSection& section = file->sections[j];
+            std::memcpy(content.get() + section.addr, section.content, section.size);
+
+            StateSection s;
+            s.type = section.type;
+            s.addr = section.addr;
+            s.size = section.size;
+            s.capacity = 0;
+            s.align = section.align;
+            for (int o = 0; o < old.sections.size(); ++o) {
+                if (old.sections[o].type == section.type) s.capacity = std::max(old.sections[o].capacity, old.sections[o].size);
+            }
+            unit.sections.push_back(s);
+
+            for (int r = 0; r < section.relocations.size(); ++r) {
+                const Relocation& rel = section.relocations[r];
+                if ((rel.offset < 0) || (rel.offset + 2 > section.size) ||
+                    (rel.id >= file->idIndex.size()) || (file->idIndex[rel.id] == nullptr)) {
+                    return nullptr;
+                }
+
+                const SymTabEntry* symbol = file->idIndex[rel.id];
+                StateRelocation sr;
+                sr.address = section.addr + rel.offset;
+                sr.type = rel.type;
+                sr.section = symbol->section;
+                sr.addend = (ElfWord)((section.content[rel.offset] & 0xFF) | ((section.content[rel.offset + 1] & 0xFF) << 8));
+
+                ElfWord target = 0;
+                if (Linker::isSectionName(file->strTab[symbol->name])) {
+                    target = this->symbolAddress(symbol, file);
+                }
+                else {
+                    sr.name = file->strTab[symbol->name].str();
+                    auto it = addresses.find(sr.name);
+                    //New undefined symbol can need an archive member, full link handles that.
+                    if (it == addresses.end()) {
+                        return nullptr;
+                    }
+                    target = it->second;
+                }
+
+                Linker::patchWord(content.get(), sr.address, sr.type, target, sr.addend);
+                unit.relocations.push_back(sr);
+            }
+        }
+
+        old = unit;
+    }
+
+    //Unchanged files only need relocations of symbols that moved.
+    for (int i = 0; i < state.units.size(); ++i) {
+        if (unitChanged[i]) continue;
+        for (int j = 0; j < state.units[i].relocations.size(); ++j) {
+            const StateRelocation& r = state.units[i].relocations[j];
+            if (!r.name.empty() && (addresses[r.name] != oldAddresses[r.name])) {
+                Linker::patchWord(content.get(), r.address, r.type, addresses[r.name], r.addend);
+            }
+        }
+    }
+
+    Executable* e = new Executable();
+    for (int i = 0; i < state.units.size(); ++i) {
+        for (int j = 0; j < state.units[i].sections.size(); ++j) {
+            const StateSection& s = state.units[i].sections[j];
+            Linker::addLimit(e, s.type, s.addr, s.size, s.align);
+        }
+        for (int j = 0; j < state.units[i].symbols.size(); ++j) {
+            const StateSymbol& s = state.units[i].symbols[j];
+            if (s.section == SectionType::TEXT) {
+                ExecutableSymbol symbol;
+                symbol.name = s.name;
+                symbol.address = s.address;
+                e->symbols.push_back(symbol);
+            }
+        }
+    }
+    Linker::finishLimits(e);
+    std::sort(e->symbols.begin(), e->symbols.end(), [](const ExecutableSymbol& a, const ExecutableSymbol& b) {
+        return (a.address != b.address) ? (a.address < b.address) : (a.name < b.name);
+    });
+
+    e->startAddress = addresses["START"];
+    e->content = content.release();
+
+    for (int i = 0; i < files.size(); ++i) {
+        state.inputs[i].hash = hashes[i];
+    }
+    state.imageHash = Utils::hash(e->content, IMAGE_CONTENT_SIZE);
+    state.write(this->incrementalImage + ".state");
+
+    for (int i = 0; i < state.units.size(); ++i) {
+        for (int j = 0; j < state.units[i].sections.size(); ++j) {
+            this->stats.sections++;
+            this->stats.imageSize += state.units[i].sections[j].size;
+        }
+        this->stats.relocations += state.units[i].relocations.size();
+    }
+    this->stats.files = state.units.size();
+
+    this->layout = std::move(state);
+    this->relinked = true;
+    return e;
+}
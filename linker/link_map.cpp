@@ -0,0 +1,100 @@
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+
+#include "linker.h"
+#include "ss_exceptions.h"
+#include "asm_declarations.h"
+
+using namespace ss;
+
+namespace {
+
+    std::string sectionName(SectionType type) {
+        switch (type) {
+            case SectionType::TEXT: return ".text";
+            case SectionType::DATA: return ".data";
+            case SectionType::RO_DATA: return ".rodata";
+            case SectionType::BSS: return ".bss";
+            default: return "udf";
+        }
+    }
+
+    std::string unitName(const LinkState& layout, const StateUnit& unit) {
+        std::string name = layout.inputs[unit.input].path;
+        return unit.member.empty() ? name : name + "(" + unit.member + ")";
+    }
+
+    struct MapSymbol {
+        ElfWord address;
+        const std::string* name;
+        const StateUnit* unit;
+    };
+}
+
+void Linker::setMap(const std::string& file) {
+    this->mapFile = file;
+}
+
+void Linker::writeMap(const Executable* e) {
+    std::ofstream out(this->mapFile, std::ofstream::out | std::ofstream::trunc);
+
+    if (!out.is_open()) {
+        throw LinkingException("Cannot open file " + this->mapFile);
+    }
+
+    out << std::hex << std::setfill('0');
+    out << "Start address: 0x" << std::setw(4) << e->startAddress << "\n\n";
+
+    //File base is its lowest placed section.
+    out << "Files:\n";
+    std::vector<MapSymbol> symbols;
+    for (int i = 0; i < this->layout.units.size(); ++i) {
+        const StateUnit& unit = this->layout.units[i];
+
+        ElfWord base = 0;
+        for (int j = 0; j < unit.sections.size(); ++j) {
+            if ((j == 0) || (unit.sections[j].addr < base)) {
+                base = unit.sections[j].addr;
+            }
+        }
+
+        out << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH * 2) << unitName(this->layout, unit)
+            << std::right << std::setfill('0') << " base 0x" << std::setw(4) << base
+            << std::dec << " relocations " << unit.relocations.size() << std::hex << "\n";
+
+        for (int j = 0; j < unit.sections.size(); ++j) {
+            const StateSection& section = unit.sections[j];
+            out << "    " << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << sectionName(section.type)
+                << std::right << std::setfill('0') << "0x" << std::setw(4) << section.addr;
+            if (section.size != 0) {
+                out << " - 0x" << std::setw(4) << section.addr + section.size - 1;
+            }
+            out << std::dec << " size " << section.size << std::hex << "\n";
+        }
+
+        for (int j = 0; j < unit.symbols.size(); ++j) {
+            MapSymbol symbol;
+            symbol.address = unit.symbols[j].address;
+            symbol.name = &unit.symbols[j].name;
+            symbol.unit = &unit;
+            symbols.push_back(symbol);
+        }
+    }
+
+    std::sort(symbols.begin(), symbols.end(), [](const MapSymbol& a, const MapSymbol& b) {
+        return (a.address != b.address) ? (a.address < b.address) : (*a.name < *b.name);
+    });
+
+    out << "\nSymbols:\n";
+    for (int i = 0; i < symbols.size(); ++i) {
+        out << "0x" << std::setw(4) << symbols[i].address << "    "
+            << std::left << std::setfill(' ') << std::setw(FIELD_LENGTH) << *symbols[i].name
+            << std::right << std::setfill('0') << " " << unitName(this->layout, *symbols[i].unit) << "\n";
+    }
+
+    if (!out.good()) {
+        throw LinkingException("Cannot write file " + this->mapFile);
+    }
+}
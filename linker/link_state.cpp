@@ -0,0 +1,191 @@
+#include <fstream>
+#include <cstring>
+#include <memory>
+
+#include "link_state.h"
+#include "mapped_file.h"
+#include "ss_exceptions.h"
+
+using namespace ss;
+
+namespace {
+
+    class StateWriter {
+    public:
+        StateWriter(std::ofstream& out) : out(out) {}
+
+        template<typename T>
+        void value(T v) {
+            out.write((const char*)&v, sizeof(T));
+        }
+
+        void string(const std::string& str) {
+            this->value((unsigned int)str.size());
+            out.write(str.data(), str.size());
+        }
+    private:
+        std::ofstream& out;
+    };
+
+    //Reads values from state file, every read fails once data runs out.
+    class StateReader {
+    public:
+        StateReader(const char* data, size_t size) : data(data), size(size), pos(0), ok(true) {}
+
+        template<typename T>
+        T value() {
+            T v = T();
+            if (!ok || (pos + sizeof(T) > size)) {
+                ok = false;
+                return v;
+            }
+            std::memcpy(&v, data + pos, sizeof(T));
+            pos += sizeof(T);
+            return v;
+        }
+
+        std::string string() {
+            unsigned int length = this->value<unsigned int>();
+            if (!ok || (length > size - pos)) {
+                ok = false;
+                return std::string();
+            }
+            std::string str(data + pos, length);
+            pos += length;
+            return str;
+        }
+
+        //Count of entries that follow, each of them at least minSize bytes long.
+        unsigned int count(size_t minSize) {
+            unsigned int n = this->value<unsigned int>();
+            if (ok && ((size_t)n * minSize > size - pos)) {
+                ok = false;
+            }
+            return ok ? n : 0;
+        }
+
+        bool good() const { return ok; }
+    private:
+        const char* data;
+        size_t size;
+        size_t pos;
+        bool ok;
+    };
+}
+
+void LinkState::write(const std::string& file) const {
+    std::ofstream out(file, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+    if (!out.is_open()) {
+        throw LinkingException("Cannot open file " + file);
+    }
+
+    StateWriter w(out);
+    out.write(LINK_STATE_MAGIC, 4);
+    w.value((unsigned int)LINK_STATE_VERSION);
+    w.value(options);
+    w.value(imageHash);
+
+    w.value((unsigned int)inputs.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+        w.string(inputs[i].path);
+        w.value(inputs[i].hash);
+        w.value((char)inputs[i].archive);
+    }
+
+    w.value((unsigned int)units.size());
+    for (int i = 0; i < units.size(); ++i) {
+        const StateUnit& u = units[i];
+        w.value(u.input);
+        w.string(u.member);
+
+        w.value((unsigned int)u.sections.size());
+        for (int j = 0; j < u.sections.size(); ++j) {
+            w.value(u.sections[j].type);
+            w.value(u.sections[j].addr);
+            w.value(u.sections[j].size);
+            w.value(u.sections[j].capacity);
+            w.value(u.sections[j].align);
+        }
+
+        w.value((unsigned int)u.symbols.size());
+        for (int j = 0; j < u.symbols.size(); ++j) {
+            w.string(u.symbols[j].name);
+            w.value(u.symbols[j].section);
+            w.value(u.symbols[j].address);
+        }
+
+        w.value((unsigned int)u.relocations.size());
+        for (int j = 0; j < u.relocations.size(); ++j) {
+            w.value(u.relocations[j].address);
+            w.value(u.relocations[j].type);
+            w.value(u.relocations[j].section);
+            w.string(u.relocations[j].name);
+            w.value(u.relocations[j].addend);
+        }
+    }
+
+    if (!out.good()) {
+        throw LinkingException("Cannot write file " + file);
+    }
+}
+
+bool LinkState::read(const std::string& file) {
+    MappedFile mapping(file);
+
+    if (!mapping.isOpen() || (mapping.size() < 8) || (std::memcmp(mapping.data(), LINK_STATE_MAGIC, 4) != 0)) {
+        return false;
+    }
+
+    StateReader r(mapping.data() + 4, mapping.size() - 4);
+    if (r.value<unsigned int>() != LINK_STATE_VERSION) {
+        return false;
+    }
+    options = r.value<unsigned long long>();
+    imageHash = r.value<unsigned long long>();
+
+    inputs.resize(r.count(13));
+    for (int i = 0; i < inputs.size(); ++i) {
+        inputs[i].path = r.string();
+        inputs[i].hash = r.value<unsigned long long>();
+        inputs[i].archive = r.value<char>() != 0;
+    }
+
+    units.resize(r.count(16));
+    for (int i = 0; i < units.size(); ++i) {
+        StateUnit& u = units[i];
+        u.input = r.value<int>();
+        u.member = r.string();
+
+        u.sections.resize(r.count(9));
+        for (int j = 0; j < u.sections.size(); ++j) {
+            u.sections[j].type = r.value<SectionType>();
+            u.sections[j].addr = r.value<ElfWord>();
+            u.sections[j].size = r.value<ElfWord>();
+            u.sections[j].capacity = r.value<ElfWord>();
+            u.sections[j].align = r.value<ElfWord>();
+        }
+
+        u.symbols.resize(r.count(7));
+        for (int j = 0; j < u.symbols.size(); ++j) {
+            u.symbols[j].name = r.string();
+            u.symbols[j].section = r.value<SectionType>();
+            u.symbols[j].address = r.value<ElfWord>();
+        }
+
+        u.relocations.resize(r.count(10));
+        for (int j = 0; j < u.relocations.size(); ++j) {
+            u.relocations[j].address = r.value<ElfWord>();
+            u.relocations[j].type = r.value<RelocationType>();
+            u.relocations[j].section = r.value<SectionType>();
+            u.relocations[j].name = r.string();
+            u.relocations[j].addend = r.value<ElfWord>();
+        }
+
+        if ((u.input < 0) || (u.input >= inputs.size())) {
+            return false;
+        }
+    }
+
+    return r.good();
+}
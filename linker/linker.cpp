@@ -0,0 +1,827 @@
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <chrono>
+#include <sys/resource.h>
+
+#include "elf.h"
+#include "linker.h"
+#include "executable.h"
+#include "relocation.h"
+#include "ss_exceptions.h"
+#include "asm_declarations.h"
+#include "string_tokenizer.h"
+#include "linking_file_data.h"
+#include "object_reader.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include "utils.h"
+//#define LINKER_OUTPUT
+using namespace ss;
+
+bool compareEntry(const LinkingFileData* l1, const LinkingFileData* l2) {
+    return l1->header.entry < l2->header.entry;
+}
+
+//Order of section types in automatically placed image.
+int sectionRank(SectionType type) {
+    switch (type) {
+        case SectionType::TEXT: return 0;
+        case SectionType::RO_DATA: return 1;
+        case SectionType::DATA: return 2;
+        default: return 3;
+    }
+}
+
+//Milliseconds since given point, which is then moved to now.
+double elapsed(std::chrono::steady_clock::time_point& since) {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(now - since).count();
+    since = now;
+    return ms;
+}
+
+//Largest resident set size of the process in kilobytes.
+long peakMemory() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+Linker::Linker() : threads(0), gcSections(false), fixedPlacement(false), ivTableInput(-1), profileHash(HASH_SEED), relinked(false) {}
+
+Linker::~Linker() {
+    for(int i = 0; i < parsedFiles.size(); ++i) {
+        delete parsedFiles[i];
+    }
+    parsedFiles.clear();
+    archives.clear();
+}
+
+Executable* Linker::linkFiles(std::vector<std::string>& files) {
+    if (files.size() == 0) {
+        throw LinkingException("No input files");
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Executable* e = nullptr;
+
+    //Previous image is patched when layout allows it, otherwise everything is linked again.
+    if (!this->incrementalImage.empty() && !this->gcSections) {
+        std::chrono::steady_clock::time_point phase = start;
+        e = this->relink(files);
+        this->stats.relink = elapsed(phase);
+    }
+
+    if (e == nullptr) {
+        e = this->linkAll(files, [&files](size_t i) {
+            return new MappedFile(files[i]);
+        });
+    }
+
+    if (!this->mapFile.empty()) {
+        this->writeMap(e);
+    }
+
+    this->stats.total = elapsed(start);
+    this->stats.peakMemory = peakMemory();
+
+    return e;
+}
+
+Executable* Linker::linkObjects(const std::vector<LinkInput>& inputs) {
+    if (inputs.size() == 0) {
+        throw LinkingException("No input files");
+    }
+
+    if (!this->incrementalImage.empty()) {
+        throw LinkingException("Incremental link of objects in memory is not supported");
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> names;
+    for (int i = 0; i < inputs.size(); ++i) {
+        names.push_back(inputs[i].name);
+    }
+
+    Executable* e = this->linkAll(names, [&inputs](size_t i) {
+        return new MappedFile(inputs[i].data, inputs[i].size);
+    });
+
+    if (!this->mapFile.empty()) {
+        this->writeMap(e);
+    }
+
+    this->stats.total = elapsed(start);
+    this->stats.peakMemory = peakMemory();
+
+    return e;
+}
+
+Executable* Linker::linkAll(const std::vector<std::string>& files, const std::function<MappedFile*(size_t)>& open) {
+    std::chrono::steady_clock::time_point phase = std::chrono::steady_clock::now();
+    ThreadPool pool(this->threads);
+    this->resolveIvTable(files);
+
+    //Files are parsed in parallel, but kept in command line order.
+    std::vector<std::unique_ptr<LinkingFileData>> objects(files.size());
+    std::vector<std::unique_ptr<Archive>> inputArchives(files.size());
+    pool.parallelFor(files.size(), [this, &files, &open, &objects, &inputArchives](size_t i) {
+        std::unique_ptr<MappedFile> mapping(open(i));
+
+        if (!mapping->isOpen()) {
+            throw LinkingException("Cannot open file " + files[i]);
+        }
+
+        if (Archive::isArchive(mapping->data(), mapping->size())) {
+            inputArchives[i].reset(new Archive(std::move(mapping), files[i]));
+        }
+        else {
+            objects[i].reset(this->parseFile(files[i], std::move(mapping)));
+        }
+    });
+
+    for (int i = 0; i < files.size(); ++i) {
+        if (objects[i] != nullptr) {
+            objects[i]->input = i;
+            this->parsedFiles.push_back(objects[i].release());
+        }
+        else {
+            this->archives.push_back(std::move(inputArchives[i]));
+            this->archiveInputs.push_back(i);
+        }
+    }
+
+    this->extractMembers(pool);
+    this->stats.parse = elapsed(phase);
+
+
+    bool startFound = false;
+    int startFile = 0;
+    const SymTabEntry* startSymbol = nullptr;
+    //Looking for start symbol.
+    for(int i = 0; i < parsedFiles.size(); ++i) {
+        for(int j = 0; j < parsedFiles[i]->symbolTable.size(); ++j) {
+            if (parsedFiles[i]->strTab[parsedFiles[i]->symbolTable[j].name].compare("START") == 0) {
+                if (startFound) {
+                    throw LinkingException("Multiple START labels found in files " 
+                                           + parsedFiles[startFile]->fileName + " "
+                                           + parsedFiles[i]->fileName);
+                }
+                else {
+                    startFound = true;
+                    startFile = i;
+                    parsedFiles[i]->containsStart = true;
+                    startSymbol = &parsedFiles[i]->symbolTable[j];
+                }
+            }
+        }
+    }
+
+    if (!startFound) {
+        throw LinkingException("Missing program starting point.");
+    }
+    LinkingFileData* startData = parsedFiles[startFile];
+
+    //Fixed placement checks files in address order, automatic keeps command line order.
+    if (this->fixedPlacement) {
+        std::stable_sort(parsedFiles.begin(), parsedFiles.end(), compareEntry);
+    }
+
+    size_t currentOffset = 0;
+
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        if (this->fixedPlacement) {
+            //Check if file overlaps with another file.
+            if (parsedFiles[i]->header.entry < currentOffset) {
+                throw LinkingException("Entry address of file " + parsedFiles[i]->fileName 
+                                          + " overlaps with " + (i == 0 ? "IV table" : "file " + parsedFiles[i - 1]->fileName));
+            }
+
+            //Check if file exceeds memory limit.
+            if (parsedFiles[i]->header.entry + parsedFiles[i]->content[0].size >= STACK_START - STACK_SIZE) {
+                throw LinkingException("Content of file " + parsedFiles[i]->fileName + " exceeds allowed memory size");
+            }
+            for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+                const InputSection& section = parsedFiles[i]->sections[j];
+                if ((size_t)section.addr + section.size >= STACK_START - STACK_SIZE) {
+                    throw LinkingException("Content of file " + parsedFiles[i]->fileName + " exceeds allowed memory size");
+                }
+            }
+        }
+
+        currentOffset = parsedFiles[i]->content[0].size + parsedFiles[i]->header.entry;
+        const ArrayView<SymTabEntry>& symTab = parsedFiles[i]->symbolTable;
+        std::vector<StringView>& strTab =  parsedFiles[i]->strTab;
+        for(int j = 0; j < symTab.size(); ++j) {
+            if (Linker::isSectionName(strTab[symTab[j].name])) {
+                continue;
+            }
+            if (symTab[j].section == SectionType::UDF) {
+                continue;
+            }
+            unsigned int nameId = parsedFiles[i]->nameIds[symTab[j].name];
+            if (this->exports[nameId] != nullptr) {
+              
+                throw LinkingException("Found multiple definitions of symbol " + strTab[symTab[j].name].str());
+            }
+            
+            this->exports[nameId] = &symTab[j];
+            this->exportFiles[nameId] = parsedFiles[i];
+        }
+    }
+
+    this->stats.symbols = elapsed(phase);
+
+    this->checkIvTable();
+
+    if (this->gcSections) {
+        this->markLiveSections(startData, startSymbol);
+    }
+    if (!this->fixedPlacement) {
+        this->placeSections();
+    }
+
+    std::unique_ptr<char[]> mergedContent(new char[((unsigned)MAX_SHORT + 1)]());
+
+    //merging content
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            const InputSection& section = parsedFiles[i]->sections[j];
+            if (section.live && (section.size != 0)) {
+                std::memcpy(mergedContent.get() + section.addr, section.content, section.size);
+            }
+        }
+    }
+
+    this->stats.merge = elapsed(phase);
+
+    //Files don't overlap and exports are no longer changed, so every file
+    //can patch its own part of merged content independently.
+    pool.parallelFor(parsedFiles.size(), [this, &mergedContent](size_t i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            if (parsedFiles[i]->sections[j].live) {
+                this->resolveSectionSymbols(mergedContent.get(), parsedFiles[i], parsedFiles[i]->sections[j]);
+            }
+        }
+    });
+
+    this->stats.relocation = elapsed(phase);
+
+    #ifdef LINKER_OUTPUT
+    std::cout<<"\n";
+
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            const InputSection& section = parsedFiles[i]->sections[j];
+            if (!section.live) continue;
+            for (int k = section.addr; k < section.addr + section.size; k++) {
+                std::cout<<std::hex<<std::setfill('0')<<std::setw(2)<<((short)mergedContent[k] & 0xFF) << " ";
+            }
+        }
+    }
+    std::cout << std::endl <<std::flush;
+    #endif
+
+    //Getting sections and setting their access rights.
+    std::cout<<std::flush;
+    Executable* e = new Executable();
+    for(int i = 0; i < parsedFiles.size(); ++i) {
+        LinkingFileData* file = parsedFiles[i];
+        for (int j = 0; j < file->sections.size(); ++j) {
+            const InputSection& section = file->sections[j];
+            if (!section.live) continue;
+
+            #ifdef LINKER_OUTPUT
+            std::cout << "File: " << file->fileName << " section: " << (int)section.type
+                    << " lower:" << section.addr << " size:" << section.size << std::endl << std::flush;
+            #endif
+            Linker::addLimit(e, section.type, section.addr, section.size, section.align);
+
+            this->stats.sections++;
+            this->stats.relocations += section.relocations.size();
+            this->stats.imageSize += section.size;
+        }
+    }
+    Linker::finishLimits(e);
+
+    this->collectSymbols(e);
+
+    e->content = mergedContent.release();
+    e->startAddress = this->symbolAddress(startSymbol, startData);
+
+    this->stats.files = parsedFiles.size();
+    this->stats.limits = elapsed(phase);
+
+    if (!this->incrementalImage.empty() || !this->mapFile.empty()) {
+        this->collectLayout(files);
+    }
+
+    if (!this->incrementalImage.empty()) {
+        //Removed sections leave no place to grow into, so such link is not kept.
+        if (this->gcSections) {
+            std::remove((this->incrementalImage + ".state").c_str());
+        }
+        else {
+            this->saveState(e);
+        }
+    }
+
+    return e;
+}
+
+void Linker::addLimit(Executable* e, SectionType type, ElfWord addr, ElfWord size, ElfWord align) {
+    //Empty section would give a limit with high below low.
+    if (size == 0) return;
+
+    Limit l;
+    l.low = addr;
+    l.high = addr + size - 1;
+    l.first = addr;
+
+    if (type == TEXT) {
+        //Text is aligned only by .align padding at its beginning, and it is moved by a
+        //multiple of its alignment, so the first instruction is at the next aligned address.
+        l.first = addr + (align - addr % align) % align;
+        e->ex.push_back(l);
+    }
+    if ((type == DATA) || (type == BSS)) {
+        e->rw.push_back(l);
+    }
+    if (type == RO_DATA) {
+        e->rd.push_back(l);
+    }
+}
+
+void Linker::finishLimits(Executable* e) {
+    Limit stack;
+    stack.high = STACK_START - 1;
+    stack.low = STACK_START - STACK_SIZE;
+    stack.first = stack.low;
+    Limit io;
+    io.high = 0x10000 - 1;
+    io.low = IO_RESERVED;
+    io.first = io.low;
+    e->rw.push_back(io);
+    e->rw.push_back(stack);
+    if (e->ex.size() != 0) {
+        std::sort(e->ex.begin(), e->ex.end());
+    }
+    if (e->rd.size() != 0) {
+        std::sort(e->rd.begin(), e->rd.end());
+    }
+    if (e->rw.size() != 0) {
+        std::sort(e->rw.begin(), e->rw.end());
+    }
+}
+
+bool Linker::isSectionName(StringView name) {
+    return (name.compare(".data") == 0) || (name.compare(".text") == 0) || (name.compare(".rodata") == 0) || (name.compare(".bss") == 0);
+}
+
+void Linker::patchWord(char* content, ElfWord address, RelocationType type, ElfWord target, ElfWord addend) {
+    ElfWord newValue = 0;
+
+    if (type == RelocationType::R_386_PC16) {
+        newValue = (ElfWord)(target + addend - address);
+    }
+
+    if (type == RelocationType::R_386_16) {
+        newValue = (ElfWord)(target + addend);
+    }
+
+    content[address] = newValue & 0xFF;
+    content[address + 1] = (newValue >> 8) & 0xFF;
+}
+
+void Linker::markLiveSections(LinkingFileData* startFile, const SymTabEntry* start) {
+    std::vector<std::pair<LinkingFileData*, InputSection*>> worklist;
+
+    auto mark = [&worklist](LinkingFileData* file, InputSection* section) {
+        if ((section != nullptr) && !section->live) {
+            section->live = true;
+            worklist.push_back(std::make_pair(file, section));
+        }
+    };
+
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            parsedFiles[i]->sections[j].live = false;
+        }
+    }
+
+    mark(startFile, startFile->findSection(start->section));
+
+    //Emulator reads interrupt vectors directly, so IV table is always reachable.
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            if (this->inIvTable(parsedFiles[i], parsedFiles[i]->sections[j])) {
+                mark(parsedFiles[i], &parsedFiles[i]->sections[j]);
+            }
+        }
+    }
+
+    while (!worklist.empty()) {
+        LinkingFileData* file = worklist.back().first;
+        InputSection* section = worklist.back().second;
+        worklist.pop_back();
+
+        for (int j = 0; j < section->relocations.size(); ++j) {
+            LinkingFileData* owner = nullptr;
+            const SymTabEntry* symbol = this->findSymbolById(section->relocations[j].id, file, owner);
+
+            //Undefined symbols are reported when relocating.
+            if (symbol != nullptr) {
+                mark(owner, owner->findSection(symbol->section));
+            }
+        }
+    }
+}
+
+const InputSection* Linker::ivTableOf(const LinkingFileData* file) const {
+    //Archive member has the input index of its archive.
+    if ((this->ivTableInput < 0) || (file->input != this->ivTableInput) || !file->member.empty()) {
+        return nullptr;
+    }
+
+    const InputSection* table = nullptr;
+    for (int j = 0; j < file->sections.size(); ++j) {
+        const InputSection& section = file->sections[j];
+        if ((section.size != 0) && ((section.type == SectionType::DATA) || (section.type == SectionType::RO_DATA))
+            && ((table == nullptr) || (section.originalAddr < table->originalAddr))) {
+            table = &section;
+        }
+    }
+
+    return table;
+}
+
+void Linker::resolveIvTable(const std::vector<std::string>& files) {
+    this->ivTableInput = -1;
+    for (int i = 0; (i < files.size()) && !this->ivTableFile.empty(); ++i) {
+        if (files[i] == this->ivTableFile) {
+            this->ivTableInput = i;
+            break;
+        }
+    }
+}
+
+void Linker::checkIvTable() const {
+    bool found = false;
+
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        const InputSection* table = this->ivTableOf(parsedFiles[i]);
+
+        if ((parsedFiles[i]->input == this->ivTableInput) && parsedFiles[i]->member.empty()) {
+            if (table == nullptr) {
+                throw LinkingException("File " + this->ivTableFile + " has no data for IV table");
+            }
+            if (table->originalAddr >= IVT_SIZE) {
+                throw LinkingException("IV table of file " + this->ivTableFile + " is not assembled at the beginning of memory");
+            }
+            found = true;
+        }
+
+        //Data where the IV table belongs is most likely a vector table linked without --ivt,
+        //moving it away would leave interrupts jumping to address 0.
+        for (int j = 0; (j < parsedFiles[i]->sections.size()) && !this->fixedPlacement; ++j) {
+            const InputSection& section = parsedFiles[i]->sections[j];
+            if ((&section != table) && Linker::inIvTableRange(section)) {
+                throw LinkingException("File " + parsedFiles[i]->fileName + " has data assembled in IV table, link its IV table with --ivt");
+            }
+        }
+    }
+
+    if (!this->ivTableFile.empty() && !found) {
+        throw LinkingException("IV table file " + this->ivTableFile + " is not linked");
+    }
+}
+
+bool Linker::inIvTableRange(const InputSection& section) {
+    return (section.size != 0) && (section.originalAddr < IVT_SIZE) &&
+           ((section.type == SectionType::DATA) || (section.type == SectionType::RO_DATA));
+}
+
+void Linker::placeSections() {
+    std::vector<std::pair<LinkingFileData*, InputSection*>> live;
+    size_t cursor = IVT_SIZE;
+
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        for (int j = 0; j < parsedFiles[i]->sections.size(); ++j) {
+            InputSection& section = parsedFiles[i]->sections[j];
+            if (!section.live) continue;
+
+            //IV table stays where emulator expects it.
+            if (this->inIvTable(parsedFiles[i], section)) {
+                section.addr = section.originalAddr;
+                cursor = std::max(cursor, (size_t)section.originalAddr + section.size);
+                continue;
+            }
+
+            live.push_back(std::make_pair(parsedFiles[i], &section));
+        }
+    }
+
+    //Code is ranked by executions of symbols it defines.
+    if (!this->profile.empty()) {
+        for (int i = 0; i < live.size(); ++i) {
+            LinkingFileData* file = live[i].first;
+            InputSection* section = live[i].second;
+            if (section->type != SectionType::TEXT) continue;
+
+            for (int j = 0; j < file->symbolTable.size(); ++j) {
+                if (file->symbolTable[j].section != SectionType::TEXT) continue;
+
+                auto it = this->profile.find(file->strTab[file->symbolTable[j].name].str());
+                if (it != this->profile.end()) {
+                    section->heat += it->second;
+                }
+            }
+        }
+    }
+
+    //Sections of the same type are packed together, in command line order. Hot code goes
+    //first so it stays contiguous, code that was never executed is pushed behind it.
+    std::stable_sort(live.begin(), live.end(), [](const std::pair<LinkingFileData*, InputSection*>& a, const std::pair<LinkingFileData*, InputSection*>& b) {
+        if (sectionRank(a.second->type) != sectionRank(b.second->type)) {
+            return sectionRank(a.second->type) < sectionRank(b.second->type);
+        }
+        return a.second->heat > b.second->heat;
+    });
+
+    //Section is moved by a multiple of its alignment, so .align padding inside it stays valid.
+    for (int i = 0; i < live.size(); ++i) {
+        InputSection* section = live[i].second;
+        size_t addr = cursor + (section->originalAddr % section->align + section->align - cursor % section->align) % section->align;
+
+        if (addr + section->size >= STACK_START - STACK_SIZE) {
+            throw LinkingException("Content of file " + live[i].first->fileName + " exceeds allowed memory size");
+        }
+
+        section->addr = addr;
+        cursor = addr + section->size;
+    }
+}
+
+void Linker::collectSymbols(Executable* e) {
+    for (int i = 0; i < parsedFiles.size(); ++i) {
+        LinkingFileData* file = parsedFiles[i];
+        for (int j = 0; j < file->symbolTable.size(); ++j) {
+            const SymTabEntry& symbol = file->symbolTable[j];
+            const InputSection* section = file->findSection(symbol.section);
+            StringView name = file->strTab[symbol.name];
+
+            if ((symbol.section != SectionType::TEXT) || (section == nullptr) || !section->live || Linker::isSectionName(name)) {
+                continue;
+            }
+
+            ExecutableSymbol s;
+            s.name = name.str();
+            s.address = this->symbolAddress(&symbol, file);
+            e->symbols.push_back(s);
+        }
+    }
+
+    std::sort(e->symbols.begin(), e->symbols.end(), [](const ExecutableSymbol& a, const ExecutableSymbol& b) {
+        return (a.address != b.address) ? (a.address < b.address) : (a.name < b.name);
+    });
+}
+
+ElfWord Linker::symbolAddress(const SymTabEntry* symbol, LinkingFileData* owner) {
+    const InputSection* section = owner->findSection(symbol->section);
+    return section != nullptr ? section->relocate(symbol->offset) : symbol->offset;
+}
+
+const SymTabEntry* Linker::findSymbolById(int id, LinkingFileData* file, LinkingFileData*& owner) {
+    if ((id < 0) || (id >= file->idIndex.size()) || (file->idIndex[id] == nullptr)) {
+        return nullptr;
+    }
+
+    const SymTabEntry* symbol = file->idIndex[id];
+    if (symbol->section != SectionType::UDF) {
+        owner = file;
+        return symbol;
+    }
+
+    //Undefined symbols are resolved through exports of other files.
+    unsigned int nameId = file->nameIds[symbol->name];
+    owner = this->exportFiles[nameId];
+    return this->exports[nameId];
+}
+
+void Linker::indexFile(LinkingFileData* file) {
+    file->nameIds.resize(file->strTab.size());
+    for (int i = 0; i < file->strTab.size(); ++i) {
+        file->nameIds[i] = this->internName(file->strTab[i]);
+    }
+}
+
+unsigned int Linker::internName(StringView name) {
+    auto it = this->nameIds.find(name);
+    if (it != this->nameIds.end()) {
+        return it->second;
+    }
+
+    unsigned int id = this->exports.size();
+    this->nameIds[name] = id;
+    this->exports.push_back(nullptr);
+    this->exportFiles.push_back(nullptr);
+
+    return id;
+}
+
+void Linker::resolveSectionSymbols(char* mergedContent, LinkingFileData* file, const InputSection& section) {
+    const ArrayView<Relocation>& rel = section.relocations;
+
+    for(int j = 0; j < rel.size(); ++j) {
+        const Relocation& r = rel[j];
+        //Patch must stay inside section, other files may be patched concurrently.
+        if ((r.offset < 0) || (r.offset + 2 > section.size)) {
+            throw LinkingException("File " + file->fileName + " is corrupted, relocation offset out of section");
+        }
+        ElfWord refaddr = section.addr + r.offset;
+        char* refptr = mergedContent + refaddr;
+        LinkingFileData* owner = nullptr;
+        const SymTabEntry* symbol = nullptr;
+
+        symbol = this->findSymbolById(r.id, file, owner);
+        
+        short oldLow = (*refptr) & 0xFF;
+        short oldHigh = *(refptr + 1) & 0xFF;
+
+        ElfWord oldValue = (oldHigh << 8) | oldLow;
+        if (symbol == nullptr) {
+            if ((r.id < file->idIndex.size()) && (file->idIndex[r.id] != nullptr)) {
+                throw LinkingException("Symbol " + file->strTab[file->idIndex[r.id]->name].str() + " not defined.");
+            }
+            throw LinkingException("Symbol with id " + std::to_string(r.id) + " not defined in file " + file->fileName);
+        }
+
+        Linker::patchWord(mergedContent, refaddr, r.type, this->symbolAddress(symbol, owner), oldValue);
+        #ifdef LINKER_OUTPUT
+          std::cout << "Relocating symbol " + owner->strTab[symbol->name].str() 
+                     << " old value:" << std::hex << (short)oldLow << ' ' <<std::hex << (short)oldHigh
+                     << " new value:" << std::hex << ((short)*refptr & 0xFF) << ' ' << std::hex << ((short)*(refptr + 1) & 0xFF) << std::endl;
+        #endif
+   }
+}
+
+void Linker::setGcSections(bool gcSections) {
+    this->gcSections = gcSections;
+}
+
+void Linker::setFixedPlacement(bool fixedPlacement) {
+    this->fixedPlacement = fixedPlacement;
+}
+
+void Linker::setIvTable(const std::string& file) {
+    this->ivTableFile = file;
+}
+
+void Linker::setProfile(const std::string& file) {
+    std::ifstream input(file);
+
+    if (!input.is_open()) {
+        throw LinkingException("Cannot open profile " + file);
+    }
+
+    //Every line holds symbol name and its execution count.
+    std::string line;
+    while (std::getline(input, line)) {
+        this->profileHash = Utils::hash(line.data(), line.size(), this->profileHash);
+
+        std::istringstream fields(line);
+        std::string name;
+        unsigned long long count = 0;
+
+        if (!(fields >> name >> count)) {
+            continue;
+        }
+        this->profile[name] += count;
+    }
+}
+
+void Linker::setThreads(unsigned int threads) {
+    this->threads = threads;
+}
+
+Executable* Linker::linkFiles(const char* files[], int num) {
+    std::vector<std::string> filesVec;
+
+    if (num <= 0) {
+        throw LinkingException("No input files");
+    } 
+    for (int i = 0; i < num; i++) {
+        filesVec.push_back(files[i]);
+    }
+
+    return this->linkFiles(filesVec);
+
+}
+
+LinkingFileData* Linker::parseFile(const std::string& file, std::unique_ptr<MappedFile> mapping) {
+
+    std::unique_ptr<LinkingFileData> lf(new LinkingFileData());
+
+    StringTokenizer st("/");
+
+    st.tokenize(file);
+    StringView name;
+    while(st.hasNext()) {
+        StringView str = st.nextToken();
+        if (!str.empty())
+            name = str;
+    }
+    if (!name.empty())
+        lf->fileName = name.str();
+
+    ObjectReader::read(mapping->data(), mapping->size(), file, lf.get());
+    lf->mapping = std::move(mapping);
+
+    return lf.release();
+}
+
+LinkingFileData* Linker::parseMember(const Archive& archive, size_t member) {
+    std::unique_ptr<LinkingFileData> lf(new LinkingFileData());
+
+    //Member data stays in the archive mapping, owned by the linker.
+    lf->fileName = archive.getName() + "(" + archive.memberName(member).str() + ")";
+    ObjectReader::read(archive.memberData(member), archive.memberSize(member), lf->fileName, lf.get());
+
+    return lf.release();
+}
+
+void Linker::extractMembers(ThreadPool& pool) {
+    std::vector<std::vector<bool>> extracted(archives.size());
+    for (int i = 0; i < archives.size(); ++i) {
+        extracted[i].assign(archives[i]->memberCount(), false);
+    }
+
+    std::vector<bool> defined;
+    //Program starting point is needed even if no object references it.
+    std::vector<StringView> undefined(1, StringView("START"));
+
+    size_t indexed = 0;
+    while (true) {
+        //Indexing files added in the previous round.
+        for (size_t i = indexed; i < parsedFiles.size(); ++i) {
+            LinkingFileData* file = parsedFiles[i];
+            this->indexFile(file);
+            defined.resize(this->exports.size(), false);
+
+            for (int j = 0; j < file->symbolTable.size(); ++j) {
+                const SymTabEntry& symbol = file->symbolTable[j];
+                if (symbol.section == SectionType::UDF) {
+                    undefined.push_back(file->strTab[symbol.name]);
+                }
+                else {
+                    defined[file->nameIds[symbol.name]] = true;
+                }
+            }
+        }
+        indexed = parsedFiles.size();
+
+        //Every archive is searched for every undefined symbol, so a name that stays
+        //undefined in this round will not be defined by a later one.
+        std::vector<std::pair<int, size_t>> needed;
+        for (int i = 0; i < undefined.size(); ++i) {
+            unsigned int nameId = this->internName(undefined[i]);
+            if (nameId >= defined.size()) defined.resize(nameId + 1, false);
+            if (defined[nameId]) continue;
+
+            for (int a = 0; a < archives.size(); ++a) {
+                int member = archives[a]->findSymbol(undefined[i]);
+                if (member < 0) continue;
+
+                if (!extracted[a][member]) {
+                    extracted[a][member] = true;
+                    needed.push_back(std::make_pair(a, (size_t)member));
+                }
+                break;
+            }
+        }
+        undefined.clear();
+
+        if (needed.empty()) break;
+
+        std::vector<std::unique_ptr<LinkingFileData>> members(needed.size());
+        pool.parallelFor(needed.size(), [this, &needed, &members](size_t i) {
+            members[i].reset(this->parseMember(*archives[needed[i].first], needed[i].second));
+        });
+
+        for (int i = 0; i < members.size(); ++i) {
+            members[i]->input = archiveInputs[needed[i].first];
+            members[i]->member = archives[needed[i].first]->memberName(needed[i].second).str();
+            parsedFiles.push_back(members[i].release());
+        }
+    }
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include "linker.h"
+#include "executable_image.h"
+#include "ss_exceptions.h"
+#include "asm_declarations.h"
+
+using namespace ss;
+
+const std::string usage = "ld [--threads <n>] [--gc-sections] [--fixed-addresses] [--ivt <object>] [--profile <file>] [--incremental] [--map <file>] [--stats] -o <output> <object or archive>...";
+
+//Prints phase times and sizes of the last link.
+void printStats(const Linker& linker) {
+    const LinkStats& s = linker.getStats();
+    std::cout << std::fixed << std::setprecision(3) << std::left;
+    if (linker.isRelinked()) {
+        std::cout << std::setw(FIELD_LENGTH) << "relink" << s.relink << " ms\n";
+    }
+    else {
+        std::cout << std::setw(FIELD_LENGTH) << "parse" << s.parse << " ms\n"
+                  << std::setw(FIELD_LENGTH) << "symbols" << s.symbols << " ms\n"
+                  << std::setw(FIELD_LENGTH) << "merge" << s.merge << " ms\n"
+                  << std::setw(FIELD_LENGTH) << "relocation" << s.relocation << " ms\n"
+                  << std::setw(FIELD_LENGTH) << "limits" << s.limits << " ms\n";
+    }
+    std::cout << std::setw(FIELD_LENGTH) << "total" << s.total << " ms\n"
+              << std::setw(FIELD_LENGTH) << "files" << s.files << "\n"
+              << std::setw(FIELD_LENGTH) << "sections" << s.sections << "\n"
+              << std::setw(FIELD_LENGTH) << "relocations" << s.relocations << "\n"
+              << std::setw(FIELD_LENGTH) << "image size" << s.imageSize << " B\n"
+              << std::setw(FIELD_LENGTH) << "peak memory" << s.peakMemory << " KB" << std::endl;
+}
+
+int main(int argc, const char* argv[]) {
+    std::string output;
+    std::vector<std::string> files;
+    unsigned int threads = 0;
+    bool gcSections = false;
+    bool fixedPlacement = false;
+    bool incremental = false;
+    bool stats = false;
+    std::string profile;
+    std::string map;
+    std::string ivTable;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+
+        if (arg.compare("-o") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing output file.\n" << usage << std::endl;
+                return -1;
+            }
+            output = argv[++i];
+        }
+        else if (arg.compare("--gc-sections") == 0) {
+            gcSections = true;
+        }
+        else if (arg.compare("--profile") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing profile file.\n" << usage << std::endl;
+                return -1;
+            }
+            profile = argv[++i];
+        }
+        else if (arg.compare("--map") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing map file.\n" << usage << std::endl;
+                return -1;
+            }
+            map = argv[++i];
+        }
+        else if (arg.compare("--stats") == 0) {
+            stats = true;
+        }
+        else if (arg.compare("--incremental") == 0) {
+            incremental = true;
+        }
+        else if (arg.compare("--fixed-addresses") == 0) {
+            fixedPlacement = true;
+        }
+        //IV table object is linked like other inputs.
+        else if (arg.compare("--ivt") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing IV table object.\n" << usage << std::endl;
+                return -1;
+            }
+            ivTable = argv[++i];
+            files.push_back(ivTable);
+        }
+        else if (arg.compare("--threads") == 0) {
+            if (i + 1 >= argc) {
+                std::cout << "ERROR: missing number of threads.\n" << usage << std::endl;
+                return -1;
+            }
+            try {
+                threads = std::stoul(argv[++i]);
+            }
+            catch (std::exception& e) {
+                std::cout << "ERROR: invalid number of threads.\n" << usage << std::endl;
+                return -1;
+            }
+        }
+        else {
+            files.push_back(arg);
+        }
+    }
+
+    if (output.empty() || files.empty()) {
+        std::cout << "ERROR: insufficient number of parameters.\n" << usage << std::endl;
+        return -1;
+    }
+
+    try {
+        Linker linker;
+        linker.setThreads(threads);
+        linker.setGcSections(gcSections);
+        linker.setFixedPlacement(fixedPlacement);
+        linker.setIvTable(ivTable);
+        if (!profile.empty()) {
+            linker.setProfile(profile);
+        }
+        if (incremental) {
+            linker.setIncremental(output);
+        }
+        if (!map.empty()) {
+            linker.setMap(map);
+        }
+        Executable* exe = linker.linkFiles(files);
+
+        ExecutableImage::write(exe, output);
+
+        ExecutableImage::release(exe);
+
+        if (stats) {
+            printStats(linker);
+        }
+    }
+    catch (std::exception& e) {
+        std::cout << e.what() << std::flush;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <fstream>
+#include <cstring>
+
+#include "archive.h"
+#include "elf.h"
+#include "object_reader.h"
+#include "linking_file_data.h"
+#include "ss_exceptions.h"
+
+using namespace ss;
+
+bool Archive::isArchive(const char* data, size_t size) {
+    return (size >= sizeof(ArchiveHeader)) && (std::memcmp(data, ARCHIVE_MAGIC, 4) == 0);
+}
+
+Archive::Archive(std::unique_ptr<MappedFile> mapping, const std::string& name) : mapping(std::move(mapping)), name(name) {
+    const char* data = this->mapping->data();
+    size_t size = this->mapping->size();
+
+    if (!Archive::isArchive(data, size)) {
+        throw LinkingException("File " + name + " is not an archive");
+    }
+
+    ArchiveHeader header;
+    std::memcpy(&header, data, sizeof(ArchiveHeader));
+
+    if (header.version != ARCHIVE_VERSION) {
+        throw LinkingException("Archive " + name + " has unsupported version " + std::to_string(header.version));
+    }
+
+    size_t membersOffset = sizeof(ArchiveHeader);
+    size_t symbolsOffset = membersOffset + (size_t)header.memberNum * sizeof(ArchiveMember);
+    size_t strTabOffset = symbolsOffset + (size_t)header.symbolNum * sizeof(ArchiveSymbol);
+
+    if ((header.memberNum > size) || (header.symbolNum > size) || (strTabOffset + header.strTabSize > size)) {
+        throw LinkingException("Archive " + name + " is corrupted, tables exceed file size");
+    }
+
+    const char* strTab = data + strTabOffset;
+
+    members.resize(header.memberNum);
+    if (header.memberNum != 0) {
+        std::memcpy(&members[0], data + membersOffset, header.memberNum * sizeof(ArchiveMember));
+    }
+    for (int i = 0; i < members.size(); ++i) {
+        if (((size_t)members[i].offset + members[i].size > size) || (members[i].offset % ARCHIVE_MEMBER_ALIGNMENT != 0)) {
+            throw LinkingException("Archive " + name + " is corrupted, invalid member " + std::to_string(i));
+        }
+        memberNames.push_back(this->readString(members[i].name, strTab, header.strTabSize));
+    }
+
+    symbols.resize(header.symbolNum);
+    if (header.symbolNum != 0) {
+        std::memcpy(&symbols[0], data + symbolsOffset, header.symbolNum * sizeof(ArchiveSymbol));
+    }
+    for (int i = 0; i < symbols.size(); ++i) {
+        if (symbols[i].member >= members.size()) {
+            throw LinkingException("Archive " + name + " is corrupted, invalid symbol " + std::to_string(i));
+        }
+        symbolNames.push_back(this->readString(symbols[i].name, strTab, header.strTabSize));
+        index.insert(std::make_pair(symbolNames[i], symbols[i].member));
+    }
+}
+
+StringView Archive::readString(unsigned int offset, const char* strTab, size_t strTabSize) const {
+    unsigned int length = 0;
+
+    if ((size_t)offset + sizeof(int) > strTabSize) {
+        throw LinkingException("Archive " + name + " is corrupted, invalid string table");
+    }
+    std::memcpy(&length, strTab + offset, sizeof(int));
+
+    if (length > strTabSize - offset - sizeof(int)) {
+        throw LinkingException("Archive " + name + " is corrupted, invalid string table");
+    }
+
+    return StringView(strTab + offset + sizeof(int), length);
+}
+
+int Archive::findSymbol(StringView symbol) const {
+    auto it = index.find(symbol);
+    return it == index.end() ? -1 : (int)it->second;
+}
+
+void Archive::write(const std::vector<std::string>& objects, const std::string& output) {
+    std::vector<std::unique_ptr<MappedFile>> mappings;
+    std::vector<ArchiveMember> members;
+    std::vector<ArchiveSymbol> symbols;
+    std::string strTab;
+    std::unordered_map<std::string, unsigned int> defined;
+
+    auto addString = [&strTab](const std::string& str) {
+        unsigned int offset = strTab.size();
+        unsigned int length = str.size();
+        strTab.append((const char*)&length, sizeof(int));
+        strTab.append(str);
+        return offset;
+    };
+
+    for (int i = 0; i < objects.size(); ++i) {
+        std::unique_ptr<MappedFile> mapping(new MappedFile(objects[i]));
+        if (!mapping->isOpen()) {
+            throw LinkingException("Cannot open file " + objects[i]);
+        }
+
+        //Reading object validates it and gives its symbols for the index.
+        LinkingFileData lf;
+        ObjectReader::read(mapping->data(), mapping->size(), objects[i], &lf);
+
+        size_t slash = objects[i].find_last_of('/');
+        ArchiveMember member;
+        member.name = addString(slash == std::string::npos ? objects[i] : objects[i].substr(slash + 1));
+        member.size = mapping->size();
+        member.offset = 0;
+        members.push_back(member);
+
+        for (int j = 0; j < lf.symbolTable.size(); ++j) {
+            const SymTabEntry& symbol = lf.symbolTable[j];
+            if ((symbol.section == SectionType::UDF) || (symbol.name >= lf.strTab.size())) {
+                continue;
+            }
+
+            StringView symbolName = lf.strTab[symbol.name];
+            if ((symbolName.compare(".data") == 0) || (symbolName.compare(".text") == 0) || (symbolName.compare(".rodata") == 0) || (symbolName.compare(".bss") == 0)) {
+                continue;
+            }
+
+            if (defined.count(symbolName.str()) != 0) {
+                continue;
+            }
+            defined[symbolName.str()] = i;
+
+            ArchiveSymbol entry;
+            entry.name = addString(symbolName.str());
+            entry.member = i;
+            symbols.push_back(entry);
+        }
+
+        mappings.push_back(std::move(mapping));
+    }
+
+    ArchiveHeader header;
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.memberNum = members.size();
+    header.symbolNum = symbols.size();
+    header.strTabSize = strTab.size();
+
+    //Member offsets are known once all tables are built.
+    size_t offset = sizeof(ArchiveHeader) + members.size() * sizeof(ArchiveMember) + symbols.size() * sizeof(ArchiveSymbol) + strTab.size();
+    for (int i = 0; i < members.size(); ++i) {
+        offset = (offset + ARCHIVE_MEMBER_ALIGNMENT - 1) / ARCHIVE_MEMBER_ALIGNMENT * ARCHIVE_MEMBER_ALIGNMENT;
+        members[i].offset = offset;
+        offset += members[i].size;
+    }
+
+    std::ofstream out(output, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+    if (!out.is_open()) {
+        throw LinkingException("Cannot open file " + output);
+    }
+
+    out.write((char*)&header, sizeof(ArchiveHeader));
+    if (members.size() != 0) out.write((char*)&members[0], members.size() * sizeof(ArchiveMember));
+    if (symbols.size() != 0) out.write((char*)&symbols[0], symbols.size() * sizeof(ArchiveSymbol));
+    out.write(strTab.data(), strTab.size());
+
+    size_t written = sizeof(ArchiveHeader) + members.size() * sizeof(ArchiveMember) + symbols.size() * sizeof(ArchiveSymbol) + strTab.size();
+    const char padding[ARCHIVE_MEMBER_ALIGNMENT] = {};
+    for (int i = 0; i < members.size(); ++i) {
+        out.write(padding, members[i].offset - written);
+        out.write(mappings[i]->data(), members[i].size);
+        written = members[i].offset + members[i].size;
+    }
+
+    if (!out.good()) {
+        throw LinkingException("Cannot write file " + output);
+    }
+}
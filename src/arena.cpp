@@ -0,0 +1,68 @@
+#include "arena.h"
+
+using namespace ss;
+
+Arena::Arena(size_t blockSize) : blockSize(blockSize) {
+
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    while (true) {
+        if (this->current < this->blocks.size()) {
+            size_t start = (this->used + align - 1) & ~(align - 1);
+            if (start + size <= this->sizes[this->current]) {
+                this->used = start + size;
+                return this->blocks[this->current] + start;
+            }
+
+            //Blocks kept after rewind are reused before new ones are allocated.
+            if (this->current + 1 < this->blocks.size()) {
+                ++this->current;
+                this->used = 0;
+                continue;
+            }
+        }
+
+        //Objects larger than a block get a block of their own.
+        size_t bytes = size + align > this->blockSize ? size + align : this->blockSize;
+        this->blocks.push_back(new char[bytes]);
+        this->sizes.push_back(bytes);
+        this->current = this->blocks.size() - 1;
+        this->used = 0;
+    }
+}
+
+Arena::Mark Arena::mark() const {
+    Mark m = {this->current, this->used, this->destructors.size()};
+    return m;
+}
+
+void Arena::rewind(const Mark& mark) {
+    this->runDestructors(mark.destructors);
+    this->current = mark.block;
+    this->used = mark.used;
+}
+
+size_t Arena::bytesUsed() const {
+    size_t bytes = this->used;
+    for (size_t i = 0; (i < this->current) && (i < this->blocks.size()); ++i) {
+        bytes += this->sizes[i];
+    }
+    return bytes;
+}
+
+void Arena::runDestructors(size_t from) {
+    while (this->destructors.size() > from) {
+        Destructor& d = this->destructors.back();
+        d.destroy(d.object);
+        this->destructors.pop_back();
+    }
+}
+
+Arena::~Arena() {
+    this->runDestructors(0);
+
+    for (size_t i = 0; i < this->blocks.size(); ++i) {
+        delete[] this->blocks[i];
+    }
+}
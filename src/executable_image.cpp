@@ -0,0 +1,147 @@
+#include <fstream>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "executable_image.h"
+#include "ss_exceptions.h"
+
+using namespace ss;
+
+void ExecutableImage::write(const Executable* e, const std::string& file) {
+    std::ofstream output(file, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+    if (!output.is_open()) {
+        throw LinkingException("Cannot open file " + file);
+    }
+
+    ImageHeader header;
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_VERSION;
+    header.startAddress = e->startAddress;
+    header.exNum = e->ex.size();
+    header.rwNum = e->rw.size();
+    header.rdNum = e->rd.size();
+
+    output.write(e->content, IMAGE_CONTENT_SIZE);
+    output.write((char*)&header, sizeof(ImageHeader));
+
+    if (header.exNum != 0) output.write((char*)&e->ex[0], header.exNum * sizeof(Limit));
+    if (header.rwNum != 0) output.write((char*)&e->rw[0], header.rwNum * sizeof(Limit));
+    if (header.rdNum != 0) output.write((char*)&e->rd[0], header.rdNum * sizeof(Limit));
+
+    unsigned short symNum = e->symbols.size();
+    output.write((char*)&symNum, sizeof(symNum));
+    for (int i = 0; i < symNum; ++i) {
+        unsigned short length = e->symbols[i].name.size();
+        output.write((char*)&e->symbols[i].address, sizeof(unsigned short));
+        output.write((char*)&length, sizeof(length));
+        output.write(e->symbols[i].name.data(), length);
+    }
+
+    if (!output.good()) {
+        throw LinkingException("Cannot write file " + file);
+    }
+}
+
+bool ExecutableImage::isImage(const std::string& file) {
+    std::ifstream input(file, std::ifstream::in | std::ifstream::binary);
+
+    if (!input.is_open()) {
+        return false;
+    }
+
+    ImageHeader header;
+    input.seekg(IMAGE_CONTENT_SIZE, std::ios_base::beg);
+    input.read((char*)&header, sizeof(ImageHeader));
+
+    return input.good() && (std::memcmp(header.magic, IMAGE_MAGIC, sizeof(header.magic)) == 0);
+}
+
+Executable* ExecutableImage::load(const std::string& file) {
+    int fd = open(file.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        throw LinkingException("Cannot open file " + file);
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < IMAGE_CONTENT_SIZE + sizeof(ImageHeader))) {
+        close(fd);
+        throw LinkingException("File " + file + " is not an executable image");
+    }
+
+    //Private mapping, emulator writes go to its own copy of the pages.
+    size_t size = st.st_size;
+    char* base = (char*)mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED) {
+        throw LinkingException("Cannot map file " + file);
+    }
+
+    ImageHeader header;
+    std::memcpy(&header, base + IMAGE_CONTENT_SIZE, sizeof(ImageHeader));
+
+    size_t limitsSize = ((size_t)header.exNum + header.rwNum + header.rdNum) * sizeof(Limit);
+    if ((std::memcmp(header.magic, IMAGE_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version < 3) || (header.version > IMAGE_VERSION) ||
+        (IMAGE_CONTENT_SIZE + sizeof(ImageHeader) + limitsSize > size)) {
+        munmap(base, size);
+        throw LinkingException("File " + file + " is corrupted or has unsupported version");
+    }
+
+    Executable* e = new Executable();
+    e->content = base;
+    e->mappedSize = size;
+    e->startAddress = header.startAddress;
+
+    const Limit* limits = (const Limit*)(base + IMAGE_CONTENT_SIZE + sizeof(ImageHeader));
+    e->ex.assign(limits, limits + header.exNum);
+    limits += header.exNum;
+    e->rw.assign(limits, limits + header.rwNum);
+    limits += header.rwNum;
+    e->rd.assign(limits, limits + header.rdNum);
+
+    //Symbols are optional, they are only used for profiling.
+    size_t pos = IMAGE_CONTENT_SIZE + sizeof(ImageHeader) + limitsSize;
+    unsigned short symNum = 0;
+    if (pos + sizeof(symNum) <= size) {
+        std::memcpy(&symNum, base + pos, sizeof(symNum));
+        pos += sizeof(symNum);
+    }
+    for (int i = 0; i < symNum; ++i) {
+        ExecutableSymbol symbol;
+        unsigned short length = 0;
+        if (pos + 2 * sizeof(unsigned short) > size) break;
+        std::memcpy(&symbol.address, base + pos, sizeof(unsigned short));
+        std::memcpy(&length, base + pos + sizeof(unsigned short), sizeof(unsigned short));
+        pos += 2 * sizeof(unsigned short);
+        if (pos + length > size) break;
+        symbol.name.assign(base + pos, length);
+        pos += length;
+        e->symbols.push_back(symbol);
+    }
+
+    return e;
+}
+
+void ExecutableImage::release(Executable* e) {
+    if (e == nullptr) {
+        return;
+    }
+
+    if (e->content != nullptr) {
+        if (e->mappedSize != 0) {
+            munmap(e->content, e->mappedSize);
+        }
+        else {
+            delete[] e->content;
+        }
+        e->content = nullptr;
+    }
+
+    delete e;
+}
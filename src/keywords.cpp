@@ -0,0 +1,134 @@
+#include <cstring>
+#include "keywords.h"
+
+using namespace ss;
+
+namespace {
+
+    constexpr size_t textLength(const char* text) {
+        return *text ? 1 + textLength(text + 1) : 0;
+    }
+
+    struct Keyword {
+        constexpr Keyword() : name(""), length(0), value(0) {}
+        constexpr Keyword(const char* name, char value) : name(name), length(textLength(name)), value(value) {}
+
+        const char* name;
+        size_t length;
+        char value;
+    };
+
+    //Words are hashed by length, first, second and last character. Tables list keywords
+    //at their slots, so moving an entry or changing parameters fails to compile.
+    template<unsigned SIZE, unsigned A, unsigned B, unsigned C>
+    struct KeywordTable {
+        static constexpr unsigned slot(const char* text, size_t length) {
+            return (length + (unsigned char)text[0] * A + (unsigned char)text[1] * B + (unsigned char)text[length - 1] * C) & (SIZE - 1);
+        }
+
+        static constexpr bool placed(const Keyword* table, unsigned i) {
+            return (i == SIZE) || (((table[i].length == 0) || (slot(table[i].name, table[i].length) == i)) && placed(table, i + 1));
+        }
+
+        static const Keyword* find(const Keyword* table, StringView text) {
+            if (text.size() < 2) {
+                return nullptr;
+            }
+
+            const Keyword& keyword = table[slot(text.data(), text.size())];
+            return ((keyword.length == text.size()) && (std::memcmp(keyword.name, text.data(), text.size()) == 0)) ? &keyword : nullptr;
+        }
+    };
+
+    using Mnemonics = KeywordTable<32, 4, 13, 7>;
+    constexpr Keyword mnemonics[32] = {
+        Keyword(), Keyword("test", InstructionCode::TEST), Keyword("div", InstructionCode::DIV), Keyword(),
+        Keyword("jmp", InstructionCode::JMP), Keyword(), Keyword("or", InstructionCode::OR), Keyword(),
+        Keyword("cmp", InstructionCode::CMP), Keyword(), Keyword("not", InstructionCode::NOT), Keyword("shl", InstructionCode::SHL),
+        Keyword(), Keyword("push", InstructionCode::PUSH), Keyword("sub", InstructionCode::SUB), Keyword(),
+        Keyword(), Keyword("call", InstructionCode::CALL), Keyword(), Keyword(),
+        Keyword("mov", InstructionCode::MOV), Keyword("shr", InstructionCode::SHR), Keyword("pop", InstructionCode::POP), Keyword("add", InstructionCode::ADD),
+        Keyword("ret", InstructionCode::RET), Keyword("and", InstructionCode::AND), Keyword(), Keyword(),
+        Keyword("mul", InstructionCode::MUL), Keyword("halt", InstructionCode::HALT), Keyword("iret", InstructionCode::IRET), Keyword()
+    };
+    static_assert(Mnemonics::placed(mnemonics, 0), "Mnemonic is not at its hash slot");
+
+    using Conditions = KeywordTable<8, 1, 0, 0>;
+    constexpr Keyword conditions[8] = {
+        Keyword("ne", ConditionCode::NE), Keyword("gt", ConditionCode::GT), Keyword(), Keyword("al", ConditionCode::AL),
+        Keyword(), Keyword(), Keyword(), Keyword("eq", ConditionCode::EQ)
+    };
+    static_assert(Conditions::placed(conditions, 0), "Condition is not at its hash slot");
+
+    using Registers = KeywordTable<16, 1, 0, 3>;
+    constexpr Keyword registers[16] = {
+        Keyword("r4", 4), Keyword(), Keyword(), Keyword("r5", 5),
+        Keyword("r0", 0), Keyword("sp", 6), Keyword("r6", 6), Keyword("r1", 1),
+        Keyword("psw", PSW_REGISTER), Keyword("r7", 7), Keyword("r2", 2), Keyword("pc", 7),
+        Keyword(), Keyword("r3", 3), Keyword(), Keyword()
+    };
+    static_assert(Registers::placed(registers, 0), "Register is not at its hash slot");
+
+    using Directives = KeywordTable<16, 0, 7, 3>;
+    constexpr Keyword directives[16] = {
+        Keyword(".char", CHAR_DIR), Keyword(), Keyword(".word", WORD_DIR), Keyword(".end", END_DIR),
+        Keyword(".data", DATA_DIR), Keyword(), Keyword(), Keyword(".align", ALIGN_DIR),
+        Keyword(".rodata", RODATA_DIR), Keyword(), Keyword(".skip", SKIP_DIR), Keyword(".bss", BSS_DIR),
+        Keyword(".global", GLOBAL_DIR), Keyword(".text", TEXT_DIR), Keyword(".long", LONG_DIR), Keyword()
+    };
+    static_assert(Directives::placed(directives, 0), "Directive is not at its hash slot");
+
+    //Pseudo instructions were never reserved.
+    bool reservedMnemonic(StringView text) {
+        const Keyword* keyword = Mnemonics::find(mnemonics, text);
+        return (keyword != nullptr) && (keyword->value != InstructionCode::JMP) && (keyword->value != InstructionCode::RET) && (keyword->value != InstructionCode::HALT);
+    }
+}
+
+bool Keywords::mnemonic(StringView text, InstructionCode& code) {
+    const Keyword* keyword = Mnemonics::find(mnemonics, text);
+    if (keyword == nullptr) {
+        return false;
+    }
+
+    code = (InstructionCode)keyword->value;
+    return true;
+}
+
+bool Keywords::condition(StringView text, ConditionCode& code) {
+    const Keyword* keyword = Conditions::find(conditions, text);
+    if (keyword == nullptr) {
+        return false;
+    }
+
+    code = (ConditionCode)keyword->value;
+    return true;
+}
+
+bool Keywords::registerNumber(StringView text, char& number) {
+    const Keyword* keyword = Registers::find(registers, text);
+    if (keyword == nullptr) {
+        return false;
+    }
+
+    number = keyword->value;
+    return true;
+}
+
+DirectiveCode Keywords::directive(StringView text) {
+    const Keyword* keyword = Directives::find(directives, text);
+    return keyword != nullptr ? (DirectiveCode)keyword->value : UNKNOWN_DIR;
+}
+
+bool Keywords::isReserved(StringView label) {
+    if ((Registers::find(registers, label) != nullptr) || reservedMnemonic(label)) {
+        return true;
+    }
+
+    ConditionCode condition;
+    if ((label.size() > 3) && (label.size() < 7) && Keywords::condition(label.substr(label.size() - 2), condition)) {
+        return reservedMnemonic(label.substr(0, label.size() - 2));
+    }
+
+    return false;
+}
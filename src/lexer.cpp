@@ -0,0 +1,146 @@
+#include "lexer.h"
+#include "keywords.h"
+using namespace ss;
+
+bool Lexer::isIdentifier(StringView text) {
+    if (text.empty() || !(isLetter(text[0]) || (text[0] == '_'))) {
+        return false;
+    }
+
+    for (size_t i = 1; i < text.size(); ++i) {
+        if (!isWordChar(text[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//First character is not checked, section names were always matched with an unescaped dot.
+bool Lexer::isSectionName(StringView text) {
+    if (text.size() < 4) {
+        return false;
+    }
+
+    StringView name = text.substr(1);
+    return (name == "bss") || (name == "text") || (name == "data") || (name == "rodata");
+}
+
+bool Lexer::isRegister(StringView text) {
+    char number;
+    return Keywords::registerNumber(text, number);
+}
+
+bool Lexer::isLabel(StringView text) {
+    return isIdentifier(text) || isSectionName(text);
+}
+
+bool Lexer::isNumber(StringView text) {
+    if (text.empty()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (!isDigit(text[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Lexer::isDecimal(StringView text) {
+    return isNumber((!text.empty() && (text[0] == '-')) ? text.substr(1) : text);
+}
+
+//Offset may be preceded by any number of spaces, tabs and opening brackets, and followed
+//by spaces and tabs before the closing bracket, so r1[5], r1[[ 5 ] and r15] are all valid.
+TokenType Lexer::registerIndirect(StringView text) {
+    if ((text.size() < 4) || (text[0] != 'r') || (text[1] < '0') || (text[1] > '7') || (text[text.size() - 1] != ']')) {
+        return INVALID_TOKEN;
+    }
+
+    size_t begin = 2;
+    size_t end = text.size() - 1;
+    while ((begin < end) && (isBlank(text[begin]) || (text[begin] == '['))) ++begin;
+    while ((end > begin) && isBlank(text[end - 1])) --end;
+
+    StringView offset = text.substr(begin, end - begin);
+    if (isDecimal(offset)) {
+        return REGIND_DEC_TOKEN;
+    }
+    if (isIdentifier(offset)) {
+        return REGIND_LAB_TOKEN;
+    }
+
+    return INVALID_TOKEN;
+}
+
+Token Lexer::operand(StringView text) {
+    Token token;
+    token.text = text;
+    token.type = INVALID_TOKEN;
+
+    char prefix = text.empty() ? 0 : text[0];
+
+    if (isRegister(text)) {
+        token.type = REGISTER_TOKEN;
+    }
+    //Section name is checked before prefixes, so &bss is a valid label value.
+    else if (isIdentifier(text) || isSectionName(text) || (((prefix == '&') || (prefix == '$')) && isIdentifier(text.substr(1)))) {
+        token.type = prefix == '&' ? LABEL_VALUE_TOKEN : prefix == '$' ? PCREL_TOKEN : LABEL_TOKEN;
+    }
+    else if ((prefix == '*') && isNumber(text.substr(1))) {
+        token.type = LOCATION_TOKEN;
+    }
+    else if (isDecimal(text)) {
+        token.type = DECIMAL_TOKEN;
+    }
+    else {
+        token.type = registerIndirect(text);
+    }
+
+    return token;
+}
+
+Token Lexer::directive(StringView line) {
+    Token token;
+    token.type = INVALID_TOKEN;
+
+    if (line.empty() || (line[0] != '.')) {
+        return token;
+    }
+
+    size_t end = line.size();
+    while ((end > 0) && isEmpty(line[end - 1])) --end;
+
+    size_t space = 0;
+    while ((space < end) && (line[space] != ' ')) ++space;
+
+    token.type = DIRECTIVE_TOKEN;
+    token.text = line.substr(0, space);
+    return token;
+}
+
+bool Lexer::mnemonic(StringView text, StringView& base, ConditionCode& condition) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (!isLetter(text[i])) {
+            return false;
+        }
+    }
+
+    if ((text.size() >= 4) && (text.size() <= 6)) {
+        if (Keywords::condition(text.substr(text.size() - 2), condition)) {
+            base = text.substr(0, text.size() - 2);
+            return true;
+        }
+    }
+
+    if ((text.size() >= 2) && (text.size() <= 4)) {
+        base = text;
+        condition = ConditionCode::AL;
+        return true;
+    }
+
+    return false;
+}
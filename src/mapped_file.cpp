@@ -0,0 +1,44 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+using namespace ss;
+
+MappedFile::MappedFile(const std::string& path) : content(nullptr), length(0), open(false), mapped(true) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return;
+    }
+
+    //Empty files cannot be mapped, they are open with no content.
+    if (st.st_size != 0) {
+        void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return;
+        }
+
+        this->content = (char*)base;
+        this->length = st.st_size;
+    }
+
+    close(fd);
+    this->open = true;
+}
+
+MappedFile::~MappedFile() {
+    if (this->mapped && (this->content != nullptr)) {
+        munmap(this->content, this->length);
+        this->content = nullptr;
+    }
+}
@@ -0,0 +1,191 @@
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <algorithm>
+
+#include "object_reader.h"
+#include "ss_exceptions.h"
+#include "asm_declarations.h"
+
+using namespace ss;
+
+void ObjectReader::read(const char* data, size_t size, const std::string& name, LinkingFileData* lf) {
+
+    //Reading elf header
+    if (size < sizeof(ELFHeader)) {
+        throw LinkingException("File " + name + " is corrupted, file is smaller than ELF header");
+    }
+    std::memcpy(&lf->header, data, sizeof(ELFHeader));
+
+    if (lf->header.shNum > EXTENDED_SECTION_NUMBER) {
+        throw LinkingException("File " + name + " is corrupted, number of section headers exceeds maximum number of section headers");
+    }
+
+    if ((lf->header.shNum != 0) && (lf->header.shEntSize != sizeof(SectionHeader))) {
+        throw LinkingException("File " + name + " is corrupted, invalid section header size");
+    }
+
+    lf->secHeaders = ObjectReader::table<SectionHeader>(data, size, lf->header.shOff, lf->header.shNum, name, lf);
+
+    //Content of text, rodata, data and bss sections is contiguous.
+    size_t contentBegin = 0;
+    size_t contentSize = 0;
+    int k = 0;
+    for(k = 0; k < lf->header.shNum; ++k) {
+        if ((lf->secHeaders[k].type == SectionType::TEXT) ||
+            (lf->secHeaders[k].type == SectionType::DATA) ||
+            (lf->secHeaders[k].type == SectionType::RO_DATA) ||
+            (lf->secHeaders[k].type == SectionType::BSS)) {
+            if (contentBegin == 0) {
+                contentBegin = lf->secHeaders[k].offset;
+            }
+
+            contentSize += lf->secHeaders[k].size;
+        }
+        else {
+            break;
+        }
+    }
+
+    if (contentBegin + contentSize > size) {
+        throw LinkingException("File " + name + " is corrupted, section content exceeds file size");
+    }
+
+    SectionContent content;
+    content.content = data + contentBegin;
+    content.size = contentSize;
+    content.startAddr = lf->header.entry;
+    
+    lf->content.push_back(content);
+
+    //Reading relocation tables, symbol table and string table
+    for(; k < lf->header.shNum; ++k) {
+        const SectionHeader& sh = lf->secHeaders[k];
+
+        switch(sh.type) {
+            case SectionType::REL_DATA:
+            case SectionType::REL_RODATA:
+            case SectionType::REL_TEXT: {
+                if ((sh.entSize != sizeof(Relocation)) || (sh.size % sizeof(Relocation) != 0)) {
+                    throw LinkingException("File " + name + " is corrupted, invalid relocation table");
+                }
+
+                ArrayView<Relocation> rel = ObjectReader::table<Relocation>(data, size, sh.offset, sh.size / sizeof(Relocation), name, lf);
+                if (sh.type == SectionType::REL_DATA) lf->relData = rel;
+                else if (sh.type == SectionType::REL_RODATA) lf->relRoData = rel;
+                else lf->relText = rel;
+                break;
+            }
+            case SectionType::STR_TAB : {
+                ObjectReader::readStringTable(data, size, sh, name, lf);
+                break;
+            }
+            case SectionType::SYMB_TAB : {
+                if ((sh.entSize != sizeof(SymTabEntry)) || (sh.size % sizeof(SymTabEntry) != 0)) {
+                    throw LinkingException("File " + name + " is corrupted, invalid symbol table");
+                }
+
+                lf->symbolTable = ObjectReader::table<SymTabEntry>(data, size, sh.offset, sh.size / sizeof(SymTabEntry), name, lf);
+                break;
+            }
+            default:
+                throw LinkingException("Unknown section, sectionCode = " + std::to_string((int)sh.type));
+                break;
+        }
+    }
+
+    //Content sections with addresses given by the assembler and their relocations.
+    for (k = 0; k < lf->header.shNum; ++k) {
+        const SectionHeader& sh = lf->secHeaders[k];
+        if ((sh.type != SectionType::TEXT) && (sh.type != SectionType::DATA) &&
+            (sh.type != SectionType::RO_DATA) && (sh.type != SectionType::BSS)) {
+            break;
+        }
+
+        //Every section must lie in the content checked above and fit in memory at its address.
+        if ((sh.offset < lf->header.ehSize) || (sh.offset < contentBegin) ||
+            ((size_t)sh.offset + sh.size > contentBegin + contentSize)) {
+            throw LinkingException("File " + name + " is corrupted, section content exceeds file content");
+        }
+
+        size_t originalAddr = (size_t)lf->header.entry + sh.offset - lf->header.ehSize;
+        if (originalAddr + sh.size > (size_t)MAX_SHORT + 1) {
+            throw LinkingException("File " + name + " is corrupted, section exceeds memory");
+        }
+
+        InputSection section;
+        section.type = sh.type;
+        section.content = data + sh.offset;
+        section.size = sh.size;
+        section.align = sh.addrAlign != 0 ? sh.addrAlign : 1;
+        section.originalAddr = originalAddr;
+        section.addr = section.originalAddr;
+        if (sh.type == SectionType::TEXT) section.relocations = lf->relText;
+        if (sh.type == SectionType::DATA) section.relocations = lf->relData;
+        if (sh.type == SectionType::RO_DATA) section.relocations = lf->relRoData;
+
+        lf->sections.push_back(section);
+    }
+
+    //Symbol table entries indexed by id, relocations refer to symbols by id.
+    ElfWord maxId = 0;
+    for (int i = 0; i < lf->symbolTable.size(); ++i) {
+        if (lf->symbolTable[i].name >= lf->strTab.size()) {
+            throw LinkingException("File " + name + " is corrupted, symbol name out of string table");
+        }
+        maxId = std::max(maxId, lf->symbolTable[i].id);
+    }
+
+    lf->idIndex.assign(lf->symbolTable.size() != 0 ? maxId + 1 : 0, nullptr);
+    for (int i = 0; i < lf->symbolTable.size(); ++i) {
+        lf->idIndex[lf->symbolTable[i].id] = &lf->symbolTable[i];
+    }
+}
+
+template<typename T>
+ArrayView<T> ObjectReader::table(const char* data, size_t size, ElfWord offset, size_t count, const std::string& name, LinkingFileData* lf) {
+    size_t bytes = count * sizeof(T);
+
+    if ((size_t)offset + bytes > size) {
+        throw LinkingException("File " + name + " is corrupted, table exceeds file size");
+    }
+
+    const char* begin = data + offset;
+
+    //Tables written by older assemblers are not aligned, those are copied once.
+    if (((uintptr_t)begin % alignof(T)) != 0) {
+        char* copy = new char[bytes];
+        std::memcpy(copy, begin, bytes);
+        lf->alignedCopies.emplace_back(copy);
+        begin = copy;
+    }
+
+    return ArrayView<T>((const T*)begin, count);
+}
+
+void ObjectReader::readStringTable(const char* data, size_t size, const SectionHeader& sh, const std::string& name, LinkingFileData* lf) {
+    size_t pos = sh.offset;
+    size_t end = (size_t)sh.offset + sh.size;
+
+    if (end > size) {
+        throw LinkingException("File " + name + " is corrupted, string table exceeds file size");
+    }
+
+    //Every string is stored as its length followed by characters.
+    while (pos < end) {
+        unsigned int length = 0;
+
+        if (pos + sizeof(int) > end) {
+            throw LinkingException("File " + name + " is corrupted, invalid string table");
+        }
+        std::memcpy(&length, data + pos, sizeof(int));
+        pos += sizeof(int);
+
+        if (length > end - pos) {
+            throw LinkingException("File " + name + " is corrupted, invalid string table");
+        }
+
+        lf->strTab.push_back(StringView(data + pos, length));
+        pos += length;
+    }
+}
@@ -1,35 +1,28 @@
 #include "operand.h"
 #include "utils.h"
 #include "asm_declarations.h"
+#include "lexer.h"
+#include "keywords.h"
 #include <string>
-#include <regex>
 using namespace ss;
 
-std::regex Operand::decimalRegex("(^(-)?[0-9]+$)");
-std::regex Operand::regIndDecRegex("^r[0-7]\[[ \\t]*(-)?[0-9]+[ \\t]*\]$");
-std::regex Operand::regIndLabRegex("^r[0-7]\[[ \\t]*[a-zA-Z_]\\w*[ \\t]*\]$");
-std::regex Operand::regDirRegex("((^r[0-7]$)|(^psw$)|(^pc$)|(^sp$))");
-std::regex Operand::labelRegex("^(((&|\\$)?[a-zA-Z_]\\w*$)|(^\.bss$)|(^\.text$)|(^\.data$)|(^\.rodata$))");
-std::regex Operand::locationRegex("^\\*[0-9]+$");
-
 Operand::Operand(const std::string op) : valid(true), text(op) {
 
-    bool regDir = std::regex_match(op, regDirRegex);
-    bool regIndLab = std::regex_match(op, regIndLabRegex);
-    bool regIndDec = std::regex_match(op, regIndDecRegex);
+    TokenType token = Lexer::operand(op).type;
     
-    if (regDir) {
-        if (op.compare("psw") == 0) {
+    if (token == REGISTER_TOKEN) {
+        char number = 0;
+        Keywords::registerNumber(op, number);
+
+        if (number == PSW_REGISTER) {
             this->extraBytes = false;
             this->type = OperandType::PSW;
             this->addressing = AddressingCode::IMMED;
         }
         else {
-            if (op.compare("pc") == 0) {
-                this->text= "r7";
-            }
-            else if(op.compare("sp") == 0) {
-                this->text = "r6";
+            //pc and sp are written as r7 and r6.
+            if (op[0] != 'r') {
+                this->text = std::string("r") + (char)('0' + number);
             }
 
             this->extraBytes = false;
@@ -37,15 +30,15 @@ Operand::Operand(const std::string op) : valid(true), text(op) {
             this->addressing = AddressingCode::REGDIR;
         }
     }
-    else if (std::regex_match(op, labelRegex) && !regIndLab && !regIndDec && !regDir) {
+    else if ((token == LABEL_TOKEN) || (token == LABEL_VALUE_TOKEN) || (token == PCREL_TOKEN)) {
         this->extraBytes = true;
 
-        if (op[0] == '&') {
+        if (token == LABEL_VALUE_TOKEN) {
             this->type = OperandType::LABEL_VAL;
             this->addressing = AddressingCode::IMMED; 
         }
         
-        else if (op[0] == '$') {
+        else if (token == PCREL_TOKEN) {
             this->type = OperandType::PCREL_VAL;
             this->addressing = AddressingCode::REGINDPOM;
         }
@@ -56,28 +49,28 @@ Operand::Operand(const std::string op) : valid(true), text(op) {
         }
     }
 
-    else if (regIndDec) {
-        this->text = Utils::removeEmptySpaces(this->text);
+    else if (token == REGIND_DEC_TOKEN) {
+        Utils::removeEmptySpaces(this->text);
         this->extraBytes = true;
         this->type = OperandType::REGIND_DEC_VAL;
         this->addressing = AddressingCode::REGINDPOM;
 
     }
 
-    else if (regIndLab) {
-        this->text = Utils::removeEmptySpaces(this->text);
+    else if (token == REGIND_LAB_TOKEN) {
+        Utils::removeEmptySpaces(this->text);
         this->extraBytes = true;
         this->type = OperandType::REGIND_LAB_VAL;
         this->addressing = AddressingCode::REGINDPOM;
     }
 
-    else if (std::regex_match(op, locationRegex)) {
+    else if (token == LOCATION_TOKEN) {
         this->extraBytes = true;
         this->type = OperandType::DECIMAL_LOCATION_VAL;
         this->addressing = AddressingCode::MEMDIR;
     }
 
-    else if (std::regex_match(op, decimalRegex)) {
+    else if (token == DECIMAL_TOKEN) {
         this->extraBytes = true;
         this->type = OperandType::IMMED_VAL;
         this->addressing = AddressingCode::IMMED;
@@ -5,88 +5,56 @@
 
 using namespace ss;
 
-void StringTokenizer::tokenize(const std::string& str) {
-    size_t pos;
-    size_t lastPos = 0;
-
-    //Creating list for storing tokens.
-    tokens = new list<std::string>();
-
-    //Coping string that needs to be formatted in new string.
-    std::string formatted(str);
-
+void StringTokenizer::tokenize(StringView str) {
     //Removing empty characters on the beggining and the end of the string.
-    formatted = Utils::trim(formatted);
-
-    //Removing repeating sequence of delimiter char in string.
-    formatted = Utils::removeRepeatingChars(formatted, delimiter);
-
-    //Finding position of the first occurence of the delimiter.
-    pos = formatted.find(delimiter, lastPos);
-    
-    if (pos != std::string::npos) {
-        while ((pos != string::npos)) {
-
-                std::string token = formatted.substr(lastPos, pos - lastPos);
-                tokens->push_back(token);
-                
-                if ((pos + 1) == formatted.length()) 
-                    tokens->push_back("");
-                lastPos = pos + 1;
-        
-            
-            
-            pos = formatted.find(delimiter, lastPos);
-        }
-    }
-    else {
-        tokens->push_back(formatted);
-        lastPos = pos;
-    }
-    
-    if (lastPos < formatted.length() && lastPos != std::string::npos) {
-        std::string token = formatted.substr(lastPos);
-        tokens->push_back(token);
-    }
-    
-    current = tokens->begin();
+    this->text = Utils::trim(str);
+    this->position = 0;
+    this->initialized = true;
+    this->finished = false;
 } 
 
-bool StringTokenizer::hasNext() {
-    if (tokens->size() == 0) {
-        return false;
-    }
-
-    if (current == tokens->end()) {
-        return false;
-    }
-
-    return true;
+bool StringTokenizer::isDelimiter(char c) const {
+    return this->delimiter.find(c) != std::string::npos;
+}
 
+bool StringTokenizer::hasNext() const {
+    return !this->finished;
 }
 
-string& StringTokenizer::nextToken() throw() {
+//Repeating delimiters count as one, delimiter at the beginning or the end gives an empty token.
+StringView StringTokenizer::nextToken() {
     if (!hasNext()) {
         throw StringTokenizerException();
     }
 
-    string& retValue = *current;
-    ++current;
-    return retValue;
+    size_t end = this->position;
+    while ((end < this->text.size()) && !this->isDelimiter(this->text[end])) ++end;
+
+    StringView token = this->text.substr(this->position, end - this->position);
+
+    if (end == this->text.size()) {
+        this->finished = true;
+    }
+    else {
+        while ((end < this->text.size()) && this->isDelimiter(this->text[end])) ++end;
+        this->position = end;
+    }
+
+    return token;
 }
 
-int StringTokenizer::tokenNumber() {
-    if (this->tokens == nullptr) {
+int StringTokenizer::tokenNumber() const {
+    if (!this->initialized) {
         //Tokenizer isn't initialized.
         return -1;
     }
 
-    else {
-        return tokens->size();
+    int count = 1;
+    for (size_t i = 0; i < this->text.size(); ++i) {
+        if (this->isDelimiter(this->text[i]) && ((i == 0) || !this->isDelimiter(this->text[i - 1]))) {
+            ++count;
+        }
     }
-}
 
-StringTokenizer::~StringTokenizer() {
-    delete tokens;
-    tokens = nullptr;
-}
\ No newline at end of file
+    return count;
+}
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include "symbol_table.h"
+#include "symbol.h"
+
+using namespace ss;
+
+#define NAME_LENGTH_SIZE sizeof(unsigned int)
+
+SymbolTable::SymbolTable() : slots(SYMBOL_TABLE_SLOTS, 0) {
+
+}
+
+StringView SymbolTable::entryName(const Entry& e) const {
+    return StringView(this->pool.data() + e.name + NAME_LENGTH_SIZE, e.length);
+}
+
+size_t SymbolTable::probe(StringView name, size_t hash) const {
+    size_t mask = this->slots.size() - 1;
+    size_t i = hash & mask;
+
+    while (this->slots[i] != 0) {
+        const Entry& e = this->entries[this->slots[i] - 1];
+        if ((e.hash == hash) && (this->entryName(e) == name)) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+Symbol* SymbolTable::find(StringView name) const {
+    size_t i = this->probe(name, StringViewHash()(name));
+    return this->slots[i] != 0 ? this->entries[this->slots[i] - 1].symbol : nullptr;
+}
+
+void SymbolTable::insert(Symbol* symbol) {
+    //Table is kept at most half full, so probes stay short.
+    if (2 * (this->filled + 1) > this->slots.size()) {
+        this->grow();
+    }
+
+    const std::string& name = symbol->getName();
+    unsigned int length = name.length();
+
+    Entry e = {symbol, this->pool.size(), length, StringViewHash()(name)};
+    this->pool.append((const char*)&length, NAME_LENGTH_SIZE);
+    this->pool.append(name);
+
+    unsigned int no = symbol->getNo();
+    if (no >= this->entries.size()) {
+        Entry none = {nullptr, 0, 0, 0};
+        this->entries.resize(no + 1, none);
+    }
+    this->entries[no] = e;
+
+    size_t i = this->probe(name, e.hash);
+    if (this->slots[i] == 0) {
+        ++this->filled;
+    }
+    this->slots[i] = no + 1;
+    ++this->live;
+}
+
+void SymbolTable::erase(Symbol* symbol) {
+    if (this->at(symbol->getNo()) == symbol) {
+        this->entries[symbol->getNo()].symbol = nullptr;
+        --this->live;
+    }
+}
+
+void SymbolTable::grow() {
+    std::vector<unsigned int> previous;
+    previous.swap(this->slots);
+    this->slots.assign(previous.size() * 2, 0);
+
+    size_t mask = this->slots.size() - 1;
+    for (unsigned int index : previous) {
+        if (index == 0) {
+            continue;
+        }
+
+        size_t i = this->entries[index - 1].hash & mask;
+        while (this->slots[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        this->slots[i] = index;
+    }
+}
+
+StringView SymbolTable::stringTableEntry(unsigned int no) const {
+    const Entry& e = this->entries[no];
+    return StringView(this->pool.data() + e.name, NAME_LENGTH_SIZE + e.length);
+}
+
+std::vector<Symbol*> SymbolTable::sortedByName() const {
+    std::vector<Symbol*> symbols;
+    symbols.reserve(this->live);
+
+    for (const Entry& e : this->entries) {
+        if (e.symbol != nullptr) {
+            symbols.push_back(e.symbol);
+        }
+    }
+
+    std::sort(symbols.begin(), symbols.end(), [](const Symbol* a, const Symbol* b) {
+        return a->getName() < b->getName();
+    });
+
+    return symbols;
+}
+
+void SymbolTable::clear() {
+    this->entries.clear();
+    this->slots.assign(SYMBOL_TABLE_SLOTS, 0);
+    this->filled = 0;
+    this->live = 0;
+    this->pool.clear();
+}
@@ -0,0 +1,103 @@
+#include "thread_pool.h"
+
+using namespace ss;
+
+ThreadPool::ThreadPool(unsigned int threads) : job(nullptr), count(0), next(0), finished(0), batch(0), stopping(false) {
+    if (threads == 0) {
+        threads = ThreadPool::defaultThreads();
+    }
+
+    //Calling thread takes part in every batch, so it is one of the threads.
+    for (unsigned int i = 1; i < threads; ++i) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+unsigned int ThreadPool::defaultThreads() {
+    unsigned int threads = std::thread::hardware_concurrency();
+    return threads == 0 ? 1 : threads;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job) {
+    if (count == 0) return;
+
+    if (workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        this->job = &job;
+        this->count = count;
+        this->next = 0;
+        this->finished = 0;
+        this->errors.assign(count, nullptr);
+        ++this->batch;
+    }
+    workCv.notify_all();
+
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    doneCv.wait(lock, [this]() { return this->finished == this->count; });
+    this->job = nullptr;
+
+    for (size_t i = 0; i < this->errors.size(); ++i) {
+        if (this->errors[i] != nullptr) {
+            std::exception_ptr error = this->errors[i];
+            this->errors.clear();
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+void ThreadPool::runJobs() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while ((this->job != nullptr) && (this->next < this->count)) {
+        size_t index = this->next++;
+        const std::function<void(size_t)>& current = *this->job;
+
+        lock.unlock();
+        std::exception_ptr error = nullptr;
+        try {
+            current(index);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        this->errors[index] = error;
+        if (++this->finished == this->count) {
+            doneCv.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            workCv.wait(lock, [this, seen]() { return this->stopping || this->batch != seen; });
+            if (this->stopping) return;
+            seen = this->batch;
+        }
+        runJobs();
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    workCv.notify_all();
+
+    for (int i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
@@ -5,31 +5,41 @@ using namespace ss;
 
 const std::string Utils::emptyChars = " \n\t\v\f\r";
 const std::string Utils::empty = "";
-std::regex Utils::labelRegex("((^[a-zA-Z_]\\w*$)|(^\.bss$)|(^\.text$)|(^\.data$)|(^\.rodata$))");
-std::regex Utils::decimalRegex("(^(-)?[0-9]+$)");
 
 std::string& Utils::trim(std::string& str) {
-    size_t front = str.find_first_not_of(Utils::emptyChars);
+    size_t back = str.find_last_not_of(Utils::emptyChars);
+    if (back != std::string::npos) {
+        str.erase(back + 1);
+    }
 
+    size_t front = str.find_first_not_of(Utils::emptyChars);
     if (front != std::string::npos) {
-        str = str.substr(front);
+        str.erase(0, front);
     }
 
-    size_t back = str.find_last_not_of(Utils::emptyChars);
-    if (back != std::string::npos) {
-        str = str.substr(0, back + 1);
+    return str;
+}
+
+StringView Utils::trim(StringView str) {
+    size_t front = 0;
+    size_t back = str.size();
+
+    while ((front < back) && (Utils::emptyChars.find(str[front]) != std::string::npos)) ++front;
+    while ((back > front) && (Utils::emptyChars.find(str[back - 1]) != std::string::npos)) --back;
+
+    if (front == back) {
+        return str;
     }
 
-    return str;
+    return str.substr(front, back - front);
 }
 
+//Characters are moved towards the beginning, write position never passes the read one.
 std::string& Utils::removeRepeatingChars(std::string& str, const std::string& chars) {
-    //std::string emptyChars = " \t\n\r\v\f";
     int j = 0;
     bool found = false;
-    std::string oldStr = std::string(str);
-    for(int i = 0; i < oldStr.length(); i++) {
-        char c = oldStr[i];
+    for(int i = 0; i < str.length(); i++) {
+        char c = str[i];
         if (chars.find(c) != std::string::npos) {
             if (found) {
                 continue;
@@ -45,24 +55,20 @@ std::string& Utils::removeRepeatingChars(std::string& str, const std::string& ch
         }
     }
 
-    str = str.substr(0, j);
+    str.resize(j);
     return str;
 }
 
-std::string Utils::removeEmptySpaces(const std::string& str) {
-    std::string newStr(str);
-
+std::string& Utils::removeEmptySpaces(std::string& str) {
     int j = 0;
     for(int i = 0; i < str.size(); i++) {
         if (Utils::emptyChars.find(str[i]) == std::string::npos) {
-            newStr[j++] = str[i];
-            continue;
+            str[j++] = str[i];
         }
     }
 
-    newStr = newStr.substr(0, j);
-
-    return newStr;
+    str.resize(j);
+    return str;
 }
 
 unsigned int Utils::findNextDivisibleByPow2(unsigned int pow, unsigned int start) {
@@ -76,4 +82,14 @@ unsigned int Utils::findNextDivisibleByPow2(unsigned int pow, unsigned int start
     for(;(start < MAX_SHORT) && (start & mask); ++start);
 
     return start;
-}
\ No newline at end of file
+}
+unsigned long long Utils::hash(const char* data, size_t size, unsigned long long seed) {
+    unsigned long long hash = seed;
+
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}